@@ -0,0 +1,44 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstddef>
+
+// Order statistics over a set of latency samples (any unit)
+struct LatencySummary {
+    size_t count = 0;
+    double min = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    double max = 0;
+};
+
+// Nearest-rank percentile of an already sorted sample, p in [0, 100]
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+// Sorts `samples` in place and summarizes them
+inline LatencySummary summarize(std::vector<double>& samples) {
+    LatencySummary summary;
+    if (samples.empty()) return summary;
+    std::sort(samples.begin(), samples.end());
+    summary.count = samples.size();
+    summary.min = samples.front();
+    summary.max = samples.back();
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    summary.p50 = percentile(samples, 50);
+    summary.p90 = percentile(samples, 90);
+    summary.p99 = percentile(samples, 99);
+    summary.p999 = percentile(samples, 99.9);
+    return summary;
+}
+
+#endif // BENCH_COMMON_H
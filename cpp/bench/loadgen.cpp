@@ -0,0 +1,198 @@
+// Closed-loop HTTP load generator for MealQualityScorer --serve.
+//
+// Every client is a thread with one keep-alive connection that sends a
+// request, waits for the full response and immediately sends the next.
+// Reports throughput and latency percentiles for each concurrency level.
+//
+//   MealLoadGen --port 8080 --clients 1,4,16,64 --seconds 5 [--paths file]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "BenchCommon.h"
+
+using namespace std;
+using namespace chrono;
+
+struct ClientResult {
+    vector<double> latenciesMicros;
+    size_t errors = 0;
+};
+
+static int connectTo(const string& host, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// Send one request and read the whole response. Returns false if the
+// connection failed or the status was not 200.
+static bool roundTrip(int fd, const string& request, string& buffer) {
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+
+    buffer.clear();
+    char chunk[16 * 1024];
+    size_t headerEnd = string::npos;
+    size_t total = 0;
+    while (true) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, n);
+        if (headerEnd == string::npos) {
+            headerEnd = buffer.find("\r\n\r\n");
+            if (headerEnd == string::npos) continue;
+            size_t lengthPos = buffer.find("Content-Length: ");
+            if (lengthPos == string::npos || lengthPos > headerEnd) return false;
+            total = headerEnd + 4 + strtoul(buffer.c_str() + lengthPos + 16, nullptr, 10);
+        }
+        if (buffer.size() >= total) break;
+    }
+    return buffer.compare(0, 12, "HTTP/1.1 200") == 0;
+}
+
+static void runClient(const string& host, int port, const vector<string>& paths, size_t offset,
+                      steady_clock::time_point deadline, ClientResult& result) {
+    vector<string> requests;
+    for (const auto& path : paths) {
+        requests.push_back("GET " + path + " HTTP/1.1\r\nHost: " + host + "\r\n\r\n");
+    }
+    string buffer;
+    int fd = connectTo(host, port);
+    size_t next = offset;
+
+    while (steady_clock::now() < deadline) {
+        if (fd < 0) {
+            result.errors++;
+            this_thread::sleep_for(milliseconds(10));
+            fd = connectTo(host, port);
+            continue;
+        }
+        const string& request = requests[next++ % requests.size()];
+        auto start = steady_clock::now();
+        bool ok = roundTrip(fd, request, buffer);
+        double micros = duration<double, micro>(steady_clock::now() - start).count();
+        if (ok) {
+            result.latenciesMicros.push_back(micros);
+        } else {
+            result.errors++;
+            close(fd);
+            fd = connectTo(host, port);
+        }
+    }
+    if (fd >= 0) close(fd);
+}
+
+// Two-letter prefix searches and completions, e.g. /search?type=prefix&q=ch
+static vector<string> defaultPaths() {
+    vector<string> paths;
+    const string first = "abcdfghkmoprstw";
+    const string second = "aehilnoru";
+    for (char a : first) {
+        for (char b : second) {
+            string prefix = string(1, a) + b;
+            paths.push_back("/search?type=prefix&limit=20&q=" + prefix);
+            paths.push_back("/complete?limit=10&q=" + prefix);
+        }
+    }
+    return paths;
+}
+
+static vector<size_t> parseList(const string& text) {
+    vector<size_t> values;
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ',')) {
+        size_t value = strtoul(item.c_str(), nullptr, 10);
+        if (value > 0) values.push_back(value);
+    }
+    return values;
+}
+
+int main(int argc, char* argv[]) {
+    string host = "127.0.0.1";
+    int port = 8080;
+    vector<size_t> clientCounts = {1, 4, 16, 64};
+    double seconds = 5;
+    vector<string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--host" && hasValue) {
+            host = argv[++i];
+        } else if (arg == "--port" && hasValue) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--clients" && hasValue) {
+            clientCounts = parseList(argv[++i]);
+        } else if (arg == "--seconds" && hasValue) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--paths" && hasValue) {
+            ifstream file(argv[++i]);
+            string line;
+            while (getline(file, line)) {
+                if (!line.empty() && line[0] == '/') paths.push_back(line);
+            }
+        } else {
+            cerr << "Usage: " << argv[0] << " [--host 127.0.0.1] [--port 8080]"
+                 << " [--clients 1,4,16,64] [--seconds 5] [--paths file]" << endl;
+            return 1;
+        }
+    }
+    if (paths.empty()) paths = defaultPaths();
+
+    cout << "clients\trequests\terrors\tqps\tp50_us\tp90_us\tp99_us\tp999_us\tmax_us" << endl;
+    for (size_t clients : clientCounts) {
+        vector<ClientResult> results(clients);
+        vector<thread> threads;
+        auto start = steady_clock::now();
+        auto deadline = start + duration_cast<steady_clock::duration>(duration<double>(seconds));
+        for (size_t c = 0; c < clients; c++) {
+            threads.emplace_back(runClient, cref(host), port, cref(paths),
+                                 c * 7, deadline, ref(results[c]));
+        }
+        for (auto& t : threads) t.join();
+        double elapsed = duration<double>(steady_clock::now() - start).count();
+
+        vector<double> all;
+        size_t errors = 0;
+        for (auto& r : results) {
+            all.insert(all.end(), r.latenciesMicros.begin(), r.latenciesMicros.end());
+            errors += r.errors;
+        }
+        LatencySummary summary = summarize(all);
+        cout << fixed << setprecision(0)
+             << clients << '\t' << summary.count << '\t' << errors << '\t'
+             << summary.count / elapsed << '\t'
+             << setprecision(1) << summary.p50 << '\t' << summary.p90 << '\t'
+             << summary.p99 << '\t' << summary.p999 << '\t' << summary.max << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,499 @@
+// Search latency benchmark for the HashMap, Trie, NameDictionary and
+// AdaptiveRadixTree backends.
+//
+// Loads the dataset once, builds every structure, then runs query mixes
+// (exact hit/miss, prefix of several lengths, contains hit/miss) against
+// each backend with warmup and many timed iterations, and times a score
+// distribution scan over double and 16-bit nutrient columns. A table goes to
+// stderr; the machine-readable JSON report goes to stdout or --json <file>
+// so runs can be diffed across commits.
+//
+//   MealBench --data nutrition.csv [--seconds 0.5] [--queries 200] [--seed 42]
+//             [--build-threads 1] [--delta-rows 10000]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <sys/resource.h>
+#include "Food.h"
+#include "HashMap.h"
+#include "Trie.h"
+#include "NameDictionary.h"
+#include "AdaptiveRadixTree.h"
+#include "DatasetAnalytics.h"
+#include "CompactNutrients.h"
+#include "CSVReader.h"
+#include "Delta.h"
+#include "OutputBuffer.h"
+#include "BenchCommon.h"
+
+using namespace std;
+using namespace chrono;
+
+#ifndef MEAL_DEFAULT_DATA_PATH
+#define MEAL_DEFAULT_DATA_PATH "../../web/data/nutrition_100k_branded.csv"
+#endif
+
+// ---- allocation counting -------------------------------------------------
+
+static atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size == 0 ? 1 : size)) return p;
+    throw bad_alloc();
+}
+
+// Kept out of line: once inlined, gcc sees free() on memory from operator
+// new and warns (-Wmismatched-new-delete) even though the pair matches
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Peak resident set size of this process so far, in MiB
+static double peakRssMb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0; // ru_maxrss is in KiB on Linux
+}
+
+// ---- query mixes ----------------------------------------------------------
+
+// xorshift64*, so query sampling is identical on every platform
+struct Rng {
+    uint64_t state;
+    explicit Rng(uint64_t seed) : state(seed ? seed : 1) {}
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+    size_t below(size_t n) { return static_cast<size_t>(next() % n); }
+};
+
+enum class SearchKind { EXACT, PREFIX, CONTAINS };
+
+struct QueryMix {
+    string name;
+    SearchKind kind;
+    vector<string> queries;
+};
+
+static string middleToken(const string& name) {
+    vector<string> tokens;
+    string current;
+    for (char c : name) {
+        if (isalnum(static_cast<unsigned char>(c))) {
+            current += c;
+        } else if (!current.empty()) {
+            tokens.push_back(current);
+            current.clear();
+        }
+    }
+    if (!current.empty()) tokens.push_back(current);
+    if (tokens.empty()) return name;
+    return tokens[tokens.size() / 2];
+}
+
+static vector<QueryMix> buildMixes(const vector<Food>& foods, size_t count, uint64_t seed) {
+    Rng rng(seed);
+    vector<string> sample;
+    for (size_t i = 0; i < count; i++) {
+        sample.push_back(foods[rng.below(foods.size())].name);
+    }
+
+    vector<QueryMix> mixes;
+    mixes.push_back({"exact_hit", SearchKind::EXACT, sample});
+
+    QueryMix exactMiss{"exact_miss", SearchKind::EXACT, {}};
+    for (const auto& name : sample) exactMiss.queries.push_back(name + " QZX");
+    mixes.push_back(exactMiss);
+
+    for (size_t length : {1, 2, 4, 8}) {
+        QueryMix prefix{"prefix_" + to_string(length), SearchKind::PREFIX, {}};
+        for (const auto& name : sample) prefix.queries.push_back(name.substr(0, length));
+        mixes.push_back(prefix);
+    }
+
+    QueryMix prefixMiss{"prefix_miss", SearchKind::PREFIX, {}};
+    for (const auto& name : sample) prefixMiss.queries.push_back("QZX" + name.substr(0, 3));
+    mixes.push_back(prefixMiss);
+
+    QueryMix contains{"contains_hit", SearchKind::CONTAINS, {}};
+    for (const auto& name : sample) contains.queries.push_back(middleToken(name));
+    mixes.push_back(contains);
+
+    QueryMix containsMiss{"contains_miss", SearchKind::CONTAINS, {}};
+    for (size_t i = 0; i < sample.size(); i++) containsMiss.queries.push_back("QZX" + to_string(i));
+    mixes.push_back(containsMiss);
+    return mixes;
+}
+
+// ---- delta ingest ---------------------------------------------------------
+
+// A synthetic delta against the loaded rows: mostly updates of existing
+// names and brand-new names in equal parts, plus some deletes
+static vector<FoodDelta> buildDelta(const vector<Food>& foods, size_t count, uint64_t seed) {
+    Rng rng(seed ^ 0xde17a);
+    vector<FoodDelta> deltas(count);
+    for (size_t i = 0; i < count; i++) {
+        FoodDelta& delta = deltas[i];
+        delta.food = foods[rng.below(foods.size())];
+        uint64_t kind = rng.below(20);
+        if (kind < 2) {
+            delta.remove = true;
+        } else if (kind < 11) {
+            delta.food.kcal += 1;
+        } else {
+            delta.food.name += " DELTA " + to_string(i);
+        }
+    }
+    return deltas;
+}
+
+// ---- backends -------------------------------------------------------------
+
+using SearchFn = function<void(const string&, vector<const Food*>&)>;
+
+struct Backend {
+    string name;
+    SearchFn exact;
+    SearchFn prefix;
+    SearchFn contains;
+
+    const SearchFn& forKind(SearchKind kind) const {
+        if (kind == SearchKind::EXACT) return exact;
+        if (kind == SearchKind::PREFIX) return prefix;
+        return contains;
+    }
+};
+
+struct CaseResult {
+    string backend;
+    string mix;
+    size_t iterations = 0;
+    LatencySummary nanos;
+    double qps = 0;
+    double allocsPerQuery = 0;
+    double resultsPerQuery = 0;
+};
+
+// Builds a snapshot index over the hashmap's foods; returns the build time
+// in ms
+template <typename Index>
+static double buildFromHashMap(Index& index, const HashMap& hashMap) {
+    auto start = steady_clock::now();
+    index.build(hashMap);
+    return duration<double, milli>(steady_clock::now() - start).count();
+}
+
+// One nutrient layout: its build, growth of peak RSS, and a full score
+// distribution pass
+struct LayoutResult {
+    double buildMs = 0;
+    double rssMb = 0;
+    LatencySummary nanosPerRow;
+    uint64_t counts[11] = {};
+};
+
+// Build `layout` from the hashmap, then time scoreCounts passes for at
+// least `seconds` (and `minIterations` passes)
+template <typename Layout>
+static LayoutResult runLayout(Layout& layout, const HashMap& hashMap, double seconds, size_t minIterations) {
+    LayoutResult result;
+    double rssBefore = peakRssMb();
+    auto start = steady_clock::now();
+    layout.build(hashMap);
+    result.buildMs = duration<double, milli>(steady_clock::now() - start).count();
+    result.rssMb = peakRssMb() - rssBefore;
+
+    layout.scoreCounts(result.counts);
+    vector<double> samples;
+    double rows = static_cast<double>(max<size_t>(1, layout.size()));
+    auto deadline = steady_clock::now() + duration_cast<steady_clock::duration>(duration<double>(seconds));
+    while (samples.size() < minIterations || steady_clock::now() < deadline) {
+        auto t0 = steady_clock::now();
+        layout.scoreCounts(result.counts);
+        samples.push_back(static_cast<double>(duration_cast<nanoseconds>(steady_clock::now() - t0).count()) / rows);
+    }
+    result.nanosPerRow = summarize(samples);
+    return result;
+}
+
+static CaseResult runCase(const Backend& backend, const QueryMix& mix,
+                          double seconds, size_t minIterations) {
+    const SearchFn& search = backend.forKind(mix.kind);
+    vector<const Food*> results;
+
+    // Warmup: up to one pass over the queries (caches, branch predictors,
+    // buffer growth), capped at a quarter of the case's time budget
+    auto warmupEnd = steady_clock::now() + duration_cast<steady_clock::duration>(duration<double>(seconds / 4));
+    for (const auto& q : mix.queries) {
+        results.clear();
+        search(q, results);
+        if (steady_clock::now() >= warmupEnd) break;
+    }
+
+    vector<double> samples;
+    size_t totalResults = 0;
+    size_t allocationsBefore = allocationCount.load();
+    auto deadline = steady_clock::now() + duration_cast<steady_clock::duration>(duration<double>(seconds));
+    auto start = steady_clock::now();
+    size_t i = 0;
+    while (samples.size() < minIterations || steady_clock::now() < deadline) {
+        const string& q = mix.queries[i++ % mix.queries.size()];
+        results.clear();
+        auto t0 = steady_clock::now();
+        search(q, results);
+        auto t1 = steady_clock::now();
+        samples.push_back(static_cast<double>(duration_cast<nanoseconds>(t1 - t0).count()));
+        totalResults += results.size();
+    }
+    double elapsed = duration<double>(steady_clock::now() - start).count();
+    size_t allocations = allocationCount.load() - allocationsBefore;
+
+    CaseResult result;
+    result.backend = backend.name;
+    result.mix = mix.name;
+    result.iterations = samples.size();
+    result.qps = samples.size() / elapsed;
+    result.allocsPerQuery = static_cast<double>(allocations) / samples.size();
+    result.resultsPerQuery = static_cast<double>(totalResults) / samples.size();
+    result.nanos = summarize(samples);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    string dataPath = MEAL_DEFAULT_DATA_PATH;
+    string jsonPath;
+    double seconds = 0.5;
+    size_t queryCount = 200;
+    uint64_t seed = 42;
+    size_t buildThreads = 1;
+    size_t deltaRows = 10000;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--data" && hasValue) {
+            dataPath = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--seconds" && hasValue) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--queries" && hasValue) {
+            queryCount = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--build-threads" && hasValue) {
+            buildThreads = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--delta-rows" && hasValue) {
+            deltaRows = strtoul(argv[++i], nullptr, 10);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--data <csv>] [--json <file>]"
+                 << " [--seconds <per case>] [--queries <n>] [--seed <n>] [--build-threads <n>]"
+                 << " [--delta-rows <n>]" << endl;
+            return 1;
+        }
+    }
+
+    // CSVReader reports progress on cout; keep stdout for the JSON report
+    streambuf* original = cout.rdbuf(cerr.rdbuf());
+    size_t allocationsBefore = allocationCount.load();
+    auto loadStart = steady_clock::now();
+    vector<Food> foods = CSVReader::loadFromCSV(dataPath);
+    double loadMs = duration<double, milli>(steady_clock::now() - loadStart).count();
+    double loadAllocsPerRow = static_cast<double>(allocationCount.load() - allocationsBefore) / max<size_t>(1, foods.size());
+    cout.rdbuf(original);
+    if (foods.empty()) {
+        cerr << "Error: No data loaded!" << endl;
+        return 1;
+    }
+
+    double loadedRssMb = peakRssMb();
+
+    // Held in optionals so teardown can be timed separately
+    optional<HashMap> hashMapOwner(in_place);
+    HashMap& hashMap = *hashMapOwner;
+    // Indexed by reference, as the application does: `foods` outlives both
+    allocationsBefore = allocationCount.load();
+    auto start = steady_clock::now();
+    hashMap.indexAll(foods.data(), foods.size(), buildThreads);
+    double hashMapBuildMs = duration<double, milli>(steady_clock::now() - start).count();
+    double hashMapRssMb = peakRssMb();
+
+    optional<Trie> trieOwner(in_place);
+    Trie& trie = *trieOwner;
+    start = steady_clock::now();
+    trie.indexAll(foods.data(), foods.size(), buildThreads);
+    double trieBuildMs = duration<double, milli>(steady_clock::now() - start).count();
+    double buildAllocsPerRow = static_cast<double>(allocationCount.load() - allocationsBefore) / foods.size();
+    double trieRssMb = peakRssMb();
+
+    // Built from the hashmap's foods, which are the same `foods` records
+    NameDictionary dictionary;
+    double dictionaryBuildMs = buildFromHashMap(dictionary, hashMap);
+    double dictionaryKib = dictionary.bytesUsed() / 1024.0;
+    AdaptiveRadixTree radixTree;
+    double radixTreeBuildMs = buildFromHashMap(radixTree, hashMap);
+    double radixTreeKib = radixTree.bytesUsed() / 1024.0;
+    cerr << fixed << setprecision(1)
+         << "Load: " << loadMs << " ms, " << setprecision(2) << loadAllocsPerRow << " allocs/row; "
+         << "index build " << buildAllocsPerRow << " allocs/row" << setprecision(1) << endl
+         << "Build: hashmap " << hashMapBuildMs << " ms (+" << hashMapRssMb - loadedRssMb << " MiB), "
+         << "trie " << trieBuildMs << " ms (+" << trieRssMb - hashMapRssMb << " MiB), "
+         << "peak RSS " << trieRssMb << " MiB" << endl
+         << "Name dictionary: " << dictionaryBuildMs << " ms, " << dictionary.names() << " names in "
+         << dictionary.nameBytes() / 1024 << " KiB front coded, " << dictionaryKib << " KiB with the FoodId mapping"
+         << endl
+         << "Adaptive radix tree: " << radixTreeBuildMs << " ms, " << radixTreeKib
+         << " KiB with the FoodId mapping" << endl;
+
+    vector<Backend> backends = {
+        {"hashmap",
+         [&](const string& q, vector<const Food*>& out) { hashMap.searchExact(q, out); },
+         [&](const string& q, vector<const Food*>& out) { hashMap.searchPrefix(q, out); },
+         [&](const string& q, vector<const Food*>& out) { hashMap.searchContains(q, out); }},
+        {"trie",
+         [&](const string& q, vector<const Food*>& out) { trie.searchExact(q, out); },
+         [&](const string& q, vector<const Food*>& out) { trie.searchPrefix(q, out); },
+         [&](const string& q, vector<const Food*>& out) { trie.searchContains(q, out); }},
+        {"namedict",
+         [&](const string& q, vector<const Food*>& out) { dictionary.searchExact(q, out); },
+         [&](const string& q, vector<const Food*>& out) { dictionary.searchPrefix(q, out); },
+         [&](const string& q, vector<const Food*>& out) { dictionary.searchContains(q, out); }},
+        {"art",
+         [&](const string& q, vector<const Food*>& out) { radixTree.searchExact(q, out); },
+         [&](const string& q, vector<const Food*>& out) { radixTree.searchPrefix(q, out); },
+         [&](const string& q, vector<const Food*>& out) { radixTree.searchContains(q, out); }},
+    };
+    vector<QueryMix> mixes = buildMixes(foods, queryCount, seed);
+
+    vector<CaseResult> results;
+    cerr << "\nbackend   mix            iters    min_ns    median_ns    p99_ns       qps  allocs/q  results/q" << endl;
+    for (const auto& backend : backends) {
+        for (const auto& mix : mixes) {
+            CaseResult r = runCase(backend, mix, seconds, 10);
+            cerr << left << setw(10) << r.backend << setw(14) << r.mix << right
+                 << setw(7) << r.iterations
+                 << fixed << setprecision(0)
+                 << setw(10) << r.nanos.min << setw(13) << r.nanos.p50 << setw(10) << r.nanos.p99
+                 << setw(10) << r.qps
+                 << setprecision(2) << setw(10) << r.allocsPerQuery
+                 << setprecision(1) << setw(11) << r.resultsPerQuery << endl;
+            results.push_back(r);
+        }
+    }
+
+    // The same score pass over 64 and 16 bytes of nutrients per food
+    DatasetAnalytics doubleLayout;
+    LayoutResult doubles = runLayout(doubleLayout, hashMap, seconds, 10);
+    double doubleKib = doubleLayout.nutrientBytes() / 1024.0;
+    CompactNutrients compactLayout;
+    LayoutResult compact = runLayout(compactLayout, hashMap, seconds, 10);
+    double compactKib = compactLayout.bytesUsed() / 1024.0;
+    const CompactNutrients::Verification& verified = compactLayout.verified();
+    bool countsMatch = equal(doubles.counts, doubles.counts + 11, compact.counts);
+    cerr << "\nNutrient layout   build_ms   rss_mb       kib  scan_ns/row (median)" << endl
+         << "double          " << setprecision(1) << setw(9) << doubles.buildMs << setw(9) << doubles.rssMb
+         << setw(10) << doubleKib << setprecision(2) << setw(13) << doubles.nanosPerRow.p50 << endl
+         << "fixed16         " << setprecision(1) << setw(9) << compact.buildMs << setw(9) << compact.rssMb
+         << setw(10) << compactKib << setprecision(2) << setw(13) << compact.nanosPerRow.p50 << endl
+         << "Verified " << verified.rows << " rows: " << verified.mismatches << " scores differ, "
+         << verified.inexact << " not stored exactly; score distributions "
+         << (countsMatch ? "match" : "differ") << setprecision(1) << endl;
+
+    // Applied after the query cases so they all run on the clean build
+    vector<FoodDelta> deltas = buildDelta(foods, deltaRows, seed);
+    start = steady_clock::now();
+    DeltaResult hashMapDelta = DeltaCSV::apply(hashMap, deltas);
+    double hashMapDeltaMs = duration<double, milli>(steady_clock::now() - start).count();
+    start = steady_clock::now();
+    DeltaCSV::apply(trie, deltas);
+    double trieDeltaMs = duration<double, milli>(steady_clock::now() - start).count();
+    cerr << "\nDelta: " << deltas.size() << " rows (" << hashMapDelta.updated << " updated, "
+         << hashMapDelta.added << " added, " << hashMapDelta.removed << " removed, "
+         << hashMapDelta.collapsed << " collapsed): hashmap "
+         << hashMapDeltaMs << " ms, trie " << trieDeltaMs << " ms" << endl;
+
+    start = steady_clock::now();
+    hashMapOwner.reset();
+    double hashMapTeardownMs = duration<double, milli>(steady_clock::now() - start).count();
+    start = steady_clock::now();
+    trieOwner.reset();
+    double trieTeardownMs = duration<double, milli>(steady_clock::now() - start).count();
+    cerr << "Teardown: hashmap " << hashMapTeardownMs << " ms, trie " << trieTeardownMs << " ms" << endl;
+
+    FILE* sink = stdout;
+    if (!jsonPath.empty()) {
+        sink = fopen(jsonPath.c_str(), "w");
+        if (sink == nullptr) {
+            cerr << "Error: Could not open file " << jsonPath << endl;
+            return 1;
+        }
+    }
+    {
+        OutputBuffer out(sink);
+        out.append("{\"dataset\":").appendJsonString(dataPath)
+           .append(",\"foods\":").append(foods.size())
+           .append(",\"seed\":").append(static_cast<long long>(seed))
+           .append(",\"queries_per_mix\":").append(queryCount)
+           .append(",\"load\":{\"ms\":").appendFixed(loadMs, 1)
+           .append(",\"allocs_per_row\":").appendFixed(loadAllocsPerRow, 3)
+           .append('}')
+           .append(",\"build\":{\"threads\":").append(buildThreads)
+           .append(",\"allocs_per_row\":").appendFixed(buildAllocsPerRow, 3)
+           .append(",\"hashmap_ms\":").appendFixed(hashMapBuildMs, 1)
+           .append(",\"trie_ms\":").appendFixed(trieBuildMs, 1)
+           .append(",\"hashmap_rss_mb\":").appendFixed(hashMapRssMb - loadedRssMb, 1)
+           .append(",\"trie_rss_mb\":").appendFixed(trieRssMb - hashMapRssMb, 1)
+           .append(",\"peak_rss_mb\":").appendFixed(trieRssMb, 1)
+           .append(",\"namedict_ms\":").appendFixed(dictionaryBuildMs, 1)
+           .append(",\"namedict_kib\":").appendFixed(dictionaryKib, 1)
+           .append(",\"art_ms\":").appendFixed(radixTreeBuildMs, 1)
+           .append(",\"art_kib\":").appendFixed(radixTreeKib, 1)
+           .append(",\"hashmap_teardown_ms\":").appendFixed(hashMapTeardownMs, 1)
+           .append(",\"trie_teardown_ms\":").appendFixed(trieTeardownMs, 1)
+           .append('}')
+           .append(",\"delta\":{\"rows\":").append(deltas.size())
+           .append(",\"hashmap_ms\":").appendFixed(hashMapDeltaMs, 2)
+           .append(",\"trie_ms\":").appendFixed(trieDeltaMs, 2)
+           .append('}')
+           .append(",\"layout\":{\"double_build_ms\":").appendFixed(doubles.buildMs, 1)
+           .append(",\"double_rss_mb\":").appendFixed(doubles.rssMb, 1)
+           .append(",\"double_kib\":").appendFixed(doubleKib, 1)
+           .append(",\"double_scan_ns_per_row\":").appendFixed(doubles.nanosPerRow.p50, 3)
+           .append(",\"fixed16_build_ms\":").appendFixed(compact.buildMs, 1)
+           .append(",\"fixed16_rss_mb\":").appendFixed(compact.rssMb, 1)
+           .append(",\"fixed16_kib\":").appendFixed(compactKib, 1)
+           .append(",\"fixed16_scan_ns_per_row\":").appendFixed(compact.nanosPerRow.p50, 3)
+           .append(",\"fixed16_mismatches\":").append(verified.mismatches)
+           .append(",\"fixed16_inexact\":").append(verified.inexact)
+           .append("},\"cases\":[");
+        for (size_t i = 0; i < results.size(); i++) {
+            const CaseResult& r = results[i];
+            out.append(i == 0 ? "\n" : ",\n")
+               .append("{\"backend\":").appendJsonString(r.backend)
+               .append(",\"mix\":").appendJsonString(r.mix)
+               .append(",\"iterations\":").append(r.iterations)
+               .append(",\"min_ns\":").appendFixed(r.nanos.min, 0)
+               .append(",\"median_ns\":").appendFixed(r.nanos.p50, 0)
+               .append(",\"p99_ns\":").appendFixed(r.nanos.p99, 0)
+               .append(",\"qps\":").appendFixed(r.qps, 1)
+               .append(",\"allocs_per_query\":").appendFixed(r.allocsPerQuery, 3)
+               .append(",\"results_per_query\":").appendFixed(r.resultsPerQuery, 2)
+               .append('}');
+        }
+        out.append("\n]}\n");
+    }
+    if (sink != stdout) fclose(sink);
+    return 0;
+}
@@ -0,0 +1,480 @@
+#ifndef ADAPTIVE_RADIX_TREE_H
+#define ADAPTIVE_RADIX_TREE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include "Food.h"
+#include "FoodTable.h"
+#include "Arena.h"
+
+// Adaptive radix tree over the distinct lowercased names: one byte per
+// level like Trie, but each node is sized to its fan-out (Node4 and Node16
+// keep sorted key bytes beside the child pointers, Node48 a 256-entry byte
+// index into 48 pointers, Node256 a direct table) and grows into the next
+// size when full. Runs of single-child levels are collapsed into one node
+// holding the whole run as its prefix, so a name costs about one node
+// where Trie spends one per character. A node whose path spells a whole
+// name carries that name's id; the foods under a name id are one slice of
+// FoodIds, as in NameDictionary. Walking children in byte order visits the
+// names sorted, so a prefix query is one descent plus an ordered walk of
+// the subtree. Like NameDictionary it is a snapshot, rebuilt when the data
+// changes; nodes live in an arena and outgrown ones are not reused.
+class AdaptiveRadixTree {
+public:
+    static const uint32_t NONE = UINT32_MAX;
+
+private:
+    enum NodeType : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+    struct Node {
+        NodeType type;
+        uint16_t children;
+        uint32_t prefixLength;
+        uint32_t name = NONE;         // id of the name ending here, or NONE
+        const unsigned char* prefix;  // points into a key stored in the arena
+    };
+
+    struct Node4 : Node {
+        unsigned char keys[4];
+        Node* child[4];
+    };
+
+    struct Node16 : Node {
+        unsigned char keys[16];
+        Node* child[16];
+    };
+
+    struct Node48 : Node {
+        unsigned char slot[256]; // 0 = no child, otherwise index + 1
+        Node* child[48];
+    };
+
+    struct Node256 : Node {
+        Node* child[256];
+    };
+
+    Arena arena;
+    Node* root = nullptr;
+    size_t nameCount = 0;
+    size_t nodeCounts[4] = {};
+    std::vector<size_t> foodStart; // nameCount + 1 offsets into foodIds
+    std::vector<FoodId> foodIds;   // grouped by name id
+    std::vector<const Food*> foods; // by FoodId, in visiting order
+
+    static std::string lower(const std::string& text) {
+        std::string result(text);
+        for (char& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    template <typename T>
+    T* create(NodeType type, const unsigned char* prefix, uint32_t prefixLength) {
+        T* node = arena.create<T>();
+        node->type = type;
+        node->children = 0;
+        node->prefix = prefix;
+        node->prefixLength = prefixLength;
+        nodeCounts[type]++;
+        return node;
+    }
+
+    // Childless node for the rest of a key
+    Node* leaf(const unsigned char* rest, size_t length, uint32_t name) {
+        Node4* node = create<Node4>(NODE4, rest, static_cast<uint32_t>(length));
+        node->name = name;
+        return node;
+    }
+
+    // Slot of the child under `byte`, or nullptr
+    static Node* const* findChild(const Node* node, unsigned char byte) {
+        switch (node->type) {
+            case NODE4: {
+                auto n = static_cast<const Node4*>(node);
+                for (int i = 0; i < n->children; i++) {
+                    if (n->keys[i] == byte) return &n->child[i];
+                }
+                return nullptr;
+            }
+            case NODE16: {
+                auto n = static_cast<const Node16*>(node);
+                const unsigned char* end = n->keys + n->children;
+                const unsigned char* at = std::lower_bound(n->keys, end, byte);
+                return at != end && *at == byte ? &n->child[at - n->keys] : nullptr;
+            }
+            case NODE48: {
+                auto n = static_cast<const Node48*>(node);
+                return n->slot[byte] != 0 ? &n->child[n->slot[byte] - 1] : nullptr;
+            }
+            default: {
+                auto n = static_cast<const Node256*>(node);
+                return n->child[byte] != nullptr ? &n->child[byte] : nullptr;
+            }
+        }
+    }
+
+    static Node** findChild(Node* node, unsigned char byte) {
+        return const_cast<Node**>(findChild(static_cast<const Node*>(node), byte));
+    }
+
+    // Insert into sorted key bytes and their parallel child pointers
+    template <typename T>
+    static void insertSorted(T* node, unsigned char byte, Node* child) {
+        int at = node->children;
+        while (at > 0 && node->keys[at - 1] > byte) {
+            node->keys[at] = node->keys[at - 1];
+            node->child[at] = node->child[at - 1];
+            at--;
+        }
+        node->keys[at] = byte;
+        node->child[at] = child;
+        node->children++;
+    }
+
+    template <typename T>
+    void copyHeader(T* to, const Node* from) {
+        to->name = from->name;
+        to->children = from->children;
+        nodeCounts[from->type]--;
+    }
+
+    // Add `child` under `byte` to the node in `slot`, moving the node into
+    // the next size up first if it is full
+    void addChild(Node** slot, unsigned char byte, Node* child) {
+        Node* node = *slot;
+        switch (node->type) {
+            case NODE4: {
+                auto n = static_cast<Node4*>(node);
+                if (n->children < 4) {
+                    insertSorted(n, byte, child);
+                    return;
+                }
+                Node16* grown = create<Node16>(NODE16, n->prefix, n->prefixLength);
+                copyHeader(grown, n);
+                std::copy(n->keys, n->keys + 4, grown->keys);
+                std::copy(n->child, n->child + 4, grown->child);
+                insertSorted(grown, byte, child);
+                *slot = grown;
+                return;
+            }
+            case NODE16: {
+                auto n = static_cast<Node16*>(node);
+                if (n->children < 16) {
+                    insertSorted(n, byte, child);
+                    return;
+                }
+                Node48* grown = create<Node48>(NODE48, n->prefix, n->prefixLength);
+                copyHeader(grown, n);
+                std::fill(grown->slot, grown->slot + 256, 0);
+                for (int i = 0; i < 16; i++) {
+                    grown->slot[n->keys[i]] = static_cast<unsigned char>(i + 1);
+                    grown->child[i] = n->child[i];
+                }
+                grown->slot[byte] = 17;
+                grown->child[16] = child;
+                grown->children++;
+                *slot = grown;
+                return;
+            }
+            case NODE48: {
+                auto n = static_cast<Node48*>(node);
+                if (n->children < 48) {
+                    n->child[n->children] = child;
+                    n->slot[byte] = static_cast<unsigned char>(++n->children);
+                    return;
+                }
+                Node256* grown = create<Node256>(NODE256, n->prefix, n->prefixLength);
+                copyHeader(grown, n);
+                std::fill(grown->child, grown->child + 256, nullptr);
+                for (int b = 0; b < 256; b++) {
+                    if (n->slot[b] != 0) grown->child[b] = n->child[n->slot[b] - 1];
+                }
+                grown->child[byte] = child;
+                grown->children++;
+                *slot = grown;
+                return;
+            }
+            default: {
+                auto n = static_cast<Node256*>(node);
+                n->child[byte] = child;
+                n->children++;
+                return;
+            }
+        }
+    }
+
+    // Insert key[0..length) (stored in the arena) as name `name`
+    void insert(const unsigned char* key, size_t length, uint32_t name) {
+        Node** slot = &root;
+        size_t depth = 0;
+        while (true) {
+            Node* node = *slot;
+            if (node == nullptr) {
+                *slot = leaf(key + depth, length - depth, name);
+                return;
+            }
+
+            // Split the node where its prefix and the key part ways
+            size_t limit = std::min<size_t>(node->prefixLength, length - depth);
+            size_t shared = 0;
+            while (shared < limit && node->prefix[shared] == key[depth + shared]) shared++;
+            if (shared < node->prefixLength) {
+                Node4* parent = create<Node4>(NODE4, node->prefix, static_cast<uint32_t>(shared));
+                unsigned char edge = node->prefix[shared];
+                node->prefix += shared + 1;
+                node->prefixLength -= static_cast<uint32_t>(shared + 1);
+                insertSorted(parent, edge, node);
+                depth += shared;
+                if (depth == length) {
+                    parent->name = name;
+                } else {
+                    insertSorted(parent, key[depth], leaf(key + depth + 1, length - depth - 1, name));
+                }
+                *slot = parent;
+                return;
+            }
+
+            depth += node->prefixLength;
+            if (depth == length) {
+                node->name = name;
+                return;
+            }
+            Node** child = findChild(node, key[depth]);
+            if (child == nullptr) {
+                addChild(slot, key[depth], leaf(key + depth + 1, length - depth - 1, name));
+                return;
+            }
+            slot = child;
+            depth++;
+        }
+    }
+
+    // Node whose subtree holds every name starting with `key`, or nullptr;
+    // `depth` is set to the key bytes above that node
+    const Node* findPrefix(const std::string& key, size_t& depth) const {
+        const Node* node = root;
+        depth = 0;
+        while (node != nullptr) {
+            size_t rest = key.size() - depth;
+            size_t compared = std::min<size_t>(node->prefixLength, rest);
+            if (std::memcmp(node->prefix, key.data() + depth, compared) != 0) return nullptr;
+            if (rest <= node->prefixLength) return node;
+            depth += node->prefixLength;
+            Node* const* child = findChild(node, static_cast<unsigned char>(key[depth]));
+            if (child == nullptr) return nullptr;
+            node = *child;
+            depth++;
+        }
+        return nullptr;
+    }
+
+    // Visit `node` and its subtree in sorted order, calling visit(nameId,
+    // path) for every name, with `path` the name so far; stops early once
+    // visit returns false
+    template <typename Fn>
+    bool walk(const Node* node, std::string& path, Fn& visit) const {
+        size_t length = path.size();
+        path.append(reinterpret_cast<const char*>(node->prefix), node->prefixLength);
+        bool going = node->name == NONE || visit(node->name, path);
+        auto descend = [&](unsigned char byte, const Node* child) {
+            path.push_back(static_cast<char>(byte));
+            going = walk(child, path, visit);
+            path.pop_back();
+        };
+        switch (node->type) {
+            case NODE4: {
+                auto n = static_cast<const Node4*>(node);
+                for (int i = 0; i < n->children && going; i++) descend(n->keys[i], n->child[i]);
+                break;
+            }
+            case NODE16: {
+                auto n = static_cast<const Node16*>(node);
+                for (int i = 0; i < n->children && going; i++) descend(n->keys[i], n->child[i]);
+                break;
+            }
+            case NODE48: {
+                auto n = static_cast<const Node48*>(node);
+                for (int b = 0; b < 256 && going; b++) {
+                    if (n->slot[b] != 0) descend(static_cast<unsigned char>(b), n->child[n->slot[b] - 1]);
+                }
+                break;
+            }
+            default: {
+                auto n = static_cast<const Node256*>(node);
+                for (int b = 0; b < 256 && going; b++) {
+                    if (n->child[b] != nullptr) descend(static_cast<unsigned char>(b), n->child[b]);
+                }
+                break;
+            }
+        }
+        path.resize(length);
+        return going;
+    }
+
+    // Same walk without building the path, for collecting foods
+    void collect(const Node* node, std::vector<const Food*>& out) const {
+        if (node->name != NONE) appendFoods(node->name, out);
+        switch (node->type) {
+            case NODE4: {
+                auto n = static_cast<const Node4*>(node);
+                for (int i = 0; i < n->children; i++) collect(n->child[i], out);
+                break;
+            }
+            case NODE16: {
+                auto n = static_cast<const Node16*>(node);
+                for (int i = 0; i < n->children; i++) collect(n->child[i], out);
+                break;
+            }
+            case NODE48: {
+                auto n = static_cast<const Node48*>(node);
+                for (int b = 0; b < 256; b++) {
+                    if (n->slot[b] != 0) collect(n->child[n->slot[b] - 1], out);
+                }
+                break;
+            }
+            default: {
+                auto n = static_cast<const Node256*>(node);
+                for (int b = 0; b < 256; b++) {
+                    if (n->child[b] != nullptr) collect(n->child[b], out);
+                }
+                break;
+            }
+        }
+    }
+
+    void appendFoods(uint32_t name, std::vector<const Food*>& out) const {
+        for (size_t i = foodStart[name]; i < foodStart[name + 1]; i++) out.push_back(foods[foodIds[i]]);
+    }
+
+public:
+    AdaptiveRadixTree() = default;
+    AdaptiveRadixTree(const AdaptiveRadixTree&) = delete;
+    AdaptiveRadixTree& operator=(const AdaptiveRadixTree&) = delete;
+
+    template <typename Source>
+    void build(const Source& source) {
+        arena.clear();
+        root = nullptr;
+        std::fill(nodeCounts, nodeCounts + 4, 0);
+        foods.clear();
+
+        // Intern the lowercased names in visiting order
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<const std::string*> distinct;
+        std::vector<uint32_t> nameOf;
+        std::string key;
+        source.forEach([&](const Food& food) {
+            key.resize(food.name.size());
+            std::transform(food.name.begin(), food.name.end(), key.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            auto inserted = ids.emplace(key, static_cast<uint32_t>(distinct.size()));
+            if (inserted.second) distinct.push_back(&inserted.first->first);
+            foods.push_back(&food);
+            nameOf.push_back(inserted.first->second);
+        });
+        nameCount = distinct.size();
+
+        // Node prefixes point into these copies of the keys
+        for (uint32_t id = 0; id < nameCount; id++) {
+            const std::string& name = *distinct[id];
+            auto bytes = static_cast<unsigned char*>(arena.allocate(name.size() + 1, 1));
+            std::memcpy(bytes, name.data(), name.size());
+            insert(bytes, name.size(), id);
+        }
+
+        // Counting sort of the foods by name id
+        foodStart.assign(nameCount + 1, 0);
+        for (uint32_t id : nameOf) foodStart[id + 1]++;
+        for (size_t n = 0; n < nameCount; n++) foodStart[n + 1] += foodStart[n];
+        std::vector<size_t> next(foodStart.begin(), foodStart.end() - 1);
+        foodIds.resize(foods.size());
+        for (FoodId id = 0; id < foods.size(); id++) foodIds[next[nameOf[id]]++] = id;
+    }
+
+    size_t size() const { return foods.size(); }
+    size_t names() const { return nameCount; }
+
+    // Id of `name` (case-insensitive), or NONE
+    uint32_t find(const std::string& name) const {
+        std::string key = lower(name);
+        const Node* node = root;
+        size_t depth = 0;
+        while (node != nullptr) {
+            if (key.size() - depth < node->prefixLength ||
+                std::memcmp(node->prefix, key.data() + depth, node->prefixLength) != 0) {
+                return NONE;
+            }
+            depth += node->prefixLength;
+            if (depth == key.size()) return node->name;
+            Node* const* child = findChild(node, static_cast<unsigned char>(key[depth]));
+            if (child == nullptr) return NONE;
+            node = *child;
+            depth++;
+        }
+        return NONE;
+    }
+
+    void searchExact(const std::string& name, std::vector<const Food*>& out) const {
+        uint32_t id = find(name);
+        if (id != NONE) appendFoods(id, out);
+    }
+
+    // Foods of every name starting with `prefix`, names in sorted order
+    void searchPrefix(const std::string& prefix, std::vector<const Food*>& out) const {
+        size_t depth;
+        const Node* node = findPrefix(lower(prefix), depth);
+        if (node != nullptr) collect(node, out);
+    }
+
+    // Walks every distinct name once rather than every food
+    void searchContains(const std::string& term, std::vector<const Food*>& out) const {
+        if (root == nullptr) return;
+        std::string key = lower(term);
+        std::string path;
+        auto visit = [&](uint32_t id, const std::string& name) {
+            if (name.find(key) != std::string::npos) appendFoods(id, out);
+            return true;
+        };
+        walk(root, path, visit);
+    }
+
+    // Up to `limit` distinct names starting with prefix, in sorted order,
+    // as spelled by their first food
+    std::vector<std::string> completeNames(const std::string& prefix, size_t limit) const {
+        std::vector<std::string> result;
+        std::string key = lower(prefix);
+        size_t depth;
+        const Node* node = findPrefix(key, depth);
+        if (node == nullptr || limit == 0) return result;
+        // The walk spells names from the node down
+        std::string path = key.substr(0, depth);
+        auto visit = [&](uint32_t id, const std::string&) {
+            result.push_back(foods[foodIds[foodStart[id]]]->name);
+            return result.size() < limit;
+        };
+        walk(node, path, visit);
+        return result;
+    }
+
+    // Bytes held by the nodes, keys and FoodId mapping
+    size_t bytesUsed() const {
+        return arena.bytesUsed() + foodStart.capacity() * sizeof(size_t) + foodIds.capacity() * sizeof(FoodId) +
+               foods.capacity() * sizeof(const Food*);
+    }
+
+    void printStats() const {
+        std::cout << "\n=== Adaptive Radix Tree Statistics ===" << std::endl;
+        std::cout << "Distinct names: " << nameCount << std::endl;
+        std::cout << "Nodes: " << nodeCounts[NODE4] << " Node4, " << nodeCounts[NODE16] << " Node16, "
+                  << nodeCounts[NODE48] << " Node48, " << nodeCounts[NODE256] << " Node256" << std::endl;
+        std::cout << "Arena: " << arena.bytesUsed() / 1024 << " KiB (nodes and keys), with the FoodId mapping "
+                  << bytesUsed() / 1024 << " KiB" << std::endl;
+    }
+};
+
+#endif // ADAPTIVE_RADIX_TREE_H
@@ -0,0 +1,104 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for many small objects with a shared lifetime.
+// Memory comes from large blocks and is only released all at once, so
+// building is a pointer increment per object and teardown is one free per
+// block. Only trivially destructible types may live here: nothing is ever
+// destroyed individually.
+class Arena {
+    static const size_t DEFAULT_BLOCK_SIZE = 1 << 20; // 1 MiB
+
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+    size_t blockSize;
+    unsigned char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t used = 0;
+    size_t reserved = 0;
+
+    void grow(size_t minimum) {
+        size_t size = minimum > blockSize ? minimum : blockSize;
+        blocks.emplace_back(new unsigned char[size]);
+        cursor = blocks.back().get();
+        remaining = size;
+        reserved += size;
+    }
+
+public:
+    explicit Arena(size_t block = DEFAULT_BLOCK_SIZE) : blockSize(block) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        size_t padding = (align - reinterpret_cast<uintptr_t>(cursor) % align) % align;
+        if (padding + size > remaining) {
+            grow(size + align);
+            padding = (align - reinterpret_cast<uintptr_t>(cursor) % align) % align;
+        }
+        unsigned char* result = cursor + padding;
+        cursor += padding + size;
+        remaining -= padding + size;
+        used += size;
+        return result;
+    }
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Arena never runs destructors");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Drop every object at once; blocks are freed, not reused
+    void clear() {
+        blocks.clear();
+        cursor = nullptr;
+        remaining = used = reserved = 0;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t bytesReserved() const { return reserved; }
+    size_t blockCount() const { return blocks.size(); }
+};
+
+// Stable-address storage for records that do own resources (e.g. Food and
+// its name). Records are constructed into fixed-size chunks, so adding one
+// never moves the others and the chunks are allocated in bulk.
+template <typename T, size_t CHUNK = 4096>
+class RecordPool {
+    std::vector<std::unique_ptr<T[]>> chunks;
+    size_t count = 0;
+
+public:
+    RecordPool() = default;
+    RecordPool(const RecordPool&) = delete;
+    RecordPool& operator=(const RecordPool&) = delete;
+    RecordPool(RecordPool&&) = default;
+    RecordPool& operator=(RecordPool&&) = default;
+
+    T* add(const T& value) {
+        if (count == chunks.size() * CHUNK) {
+            chunks.emplace_back(new T[CHUNK]);
+        }
+        T* slot = &chunks[count / CHUNK][count % CHUNK];
+        *slot = value;
+        count++;
+        return slot;
+    }
+
+    size_t size() const { return count; }
+    size_t bytesReserved() const { return chunks.size() * CHUNK * sizeof(T); }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,287 @@
+#ifndef BACKGROUND_LOADER_H
+#define BACKGROUND_LOADER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include "Food.h"
+#include "CSVReader.h"
+#include "Delta.h"
+#include "HashMap.h"
+#include "Trie.h"
+
+// Loads the dataset on a background thread in stages: parse the CSV, then
+// build the HashMap and the Trie (concurrently), then run the tasks given
+// to derive() (indexes built from those two). Each stage publishes a ready
+// flag as soon as it finishes, so callers can use whatever is ready, wait
+// for what they need, or scan the rows parsed so far.
+// The loader owns the parsed rows; both indexes point into them. Delta
+// files given to start() are applied to each index before it is published.
+class BackgroundLoader {
+public:
+    enum Stage { PARSED = 0, HASHMAP_READY = 1, TRIE_READY = 2, DERIVED_READY = 3, STAGE_COUNT = 4 };
+
+private:
+    // Rows handed to the indexes per call, so build progress can be tracked
+    static const size_t BUILD_SLICE = 1 << 16;
+    // Rows parsed before they are published to scanners under the lock
+    static const size_t PUBLISH_BATCH = 4096;
+
+    using Clock = std::chrono::steady_clock;
+
+    HashMap& hashMap;
+    Trie& trie;
+    std::string path;
+    std::vector<std::string> deltaPaths;
+    std::vector<FoodDelta> deltas;
+    size_t hashMapThreads = 1;
+    size_t trieThreads = 1;
+    std::vector<std::function<void()>> derivedTasks;
+    std::thread worker;
+
+    std::atomic<bool> ready[STAGE_COUNT];
+    std::atomic<bool> failed{false};
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    // Parsed rows; appended under `mutex` while parsing, read-only after
+    // (the indexes reference them, so they must never move once built)
+    std::vector<Food> foods;
+
+    std::atomic<size_t> bytesRead{0};
+    std::atomic<size_t> totalBytes{0};
+    std::atomic<size_t> rowsIndexed[STAGE_COUNT];
+    Clock::time_point started;
+    Clock::time_point buildStarted;
+    std::atomic<long long> stageMs[STAGE_COUNT];
+    std::atomic<long long> indexMs{0};
+
+    static long long millisSince(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    }
+
+    void publish(Stage stage) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready[stage].store(true, std::memory_order_release);
+        }
+        changed.notify_all();
+    }
+
+    void fail() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed.store(true);
+        }
+        changed.notify_all();
+    }
+
+    bool parse() {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        totalBytes.store(static_cast<size_t>(file.tellg()));
+        size_t expected = CSVReader::estimateRows(file);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            foods.reserve(expected);
+        }
+
+        std::vector<Food> pending;
+        pending.reserve(PUBLISH_BATCH);
+        std::vector<std::string> fields;
+        std::string line;
+        size_t bytes = 0;
+        bool firstLine = true;
+        while (std::getline(file, line) && !cancelled.load(std::memory_order_relaxed)) {
+            bytes += line.size() + 1;
+            if (firstLine) {
+                firstLine = false;
+                continue;
+            }
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            pending.emplace_back();
+            if (!CSVReader::parseFood(line, fields, pending.back())) pending.pop_back();
+            if (pending.size() >= PUBLISH_BATCH) {
+                std::lock_guard<std::mutex> lock(mutex);
+                foods.insert(foods.end(), std::make_move_iterator(pending.begin()),
+                             std::make_move_iterator(pending.end()));
+                pending.clear();
+                bytesRead.store(bytes, std::memory_order_relaxed);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        foods.insert(foods.end(), std::make_move_iterator(pending.begin()),
+                     std::make_move_iterator(pending.end()));
+        bytesRead.store(bytes, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Feed the parsed rows to one index a slice at a time
+    template <typename Index>
+    void build(Index& index, size_t threads, Stage stage) {
+        auto start = Clock::now();
+        for (size_t first = 0; first < foods.size() && !cancelled.load(); first += BUILD_SLICE) {
+            size_t count = std::min(BUILD_SLICE, foods.size() - first);
+            index.indexAll(foods.data() + first, count, threads);
+            rowsIndexed[stage].store(first + count, std::memory_order_relaxed);
+        }
+        DeltaCSV::apply(index, deltas);
+        stageMs[stage].store(millisSince(start));
+        {
+            // The index total is whichever build finishes last
+            std::lock_guard<std::mutex> lock(mutex);
+            indexMs.store(std::max(indexMs.load(), millisSince(buildStarted)));
+        }
+        publish(stage);
+    }
+
+    void load() {
+        if (!parse()) return fail();
+        stageMs[PARSED].store(millisSince(started));
+        if (foods.empty()) return fail();
+        for (const auto& deltaPath : deltaPaths) {
+            if (!DeltaCSV::load(deltaPath, deltas)) return fail();
+        }
+        publish(PARSED);
+
+        buildStarted = Clock::now();
+        std::thread hashMapBuilder([this]() { build(hashMap, hashMapThreads, HASHMAP_READY); });
+        build(trie, trieThreads, TRIE_READY);
+        hashMapBuilder.join();
+
+        auto start = Clock::now();
+        for (const auto& task : derivedTasks) {
+            if (cancelled.load()) return;
+            task();
+        }
+        stageMs[DERIVED_READY].store(millisSince(start));
+        publish(DERIVED_READY);
+    }
+
+    // Seconds left for a stage that is `fraction` done after `elapsed`
+    // seconds, or -1 before there is anything to extrapolate from
+    static double eta(double fraction, double elapsed) {
+        if (fraction <= 0) return -1;
+        return elapsed * (1 - fraction) / fraction;
+    }
+
+public:
+    BackgroundLoader(HashMap& hm, Trie& tr) : hashMap(hm), trie(tr) {
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            ready[i].store(false);
+            rowsIndexed[i].store(0);
+            stageMs[i].store(0);
+        }
+    }
+
+    ~BackgroundLoader() {
+        cancelled.store(true);
+        if (worker.joinable()) worker.join();
+    }
+
+    BackgroundLoader(const BackgroundLoader&) = delete;
+    BackgroundLoader& operator=(const BackgroundLoader&) = delete;
+
+    // Run `task` on the loader thread, in the order given, once both
+    // indexes are published; DERIVED_READY follows the last one. Call
+    // before start().
+    void derive(std::function<void()> task) { derivedTasks.push_back(std::move(task)); }
+
+    // Start loading `filename`, then the `deltaFiles` on top of it; the
+    // indexes share the cores, with the trie (about three times slower to
+    // build) getting most of them
+    void start(const std::string& filename, const std::vector<std::string>& deltaFiles = {}) {
+        path = filename;
+        deltaPaths = deltaFiles;
+        size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        hashMapThreads = std::max<size_t>(1, cores / 4);
+        trieThreads = std::max<size_t>(1, cores - hashMapThreads);
+        started = Clock::now();
+        worker = std::thread(&BackgroundLoader::load, this);
+    }
+
+    bool isReady(Stage stage) const { return ready[stage].load(std::memory_order_acquire); }
+    bool isDone() const { return isReady(HASHMAP_READY) && isReady(TRIE_READY) && isReady(DERIVED_READY); }
+    bool hasFailed() const { return failed.load(); }
+    const std::string& dataPath() const { return path; }
+    size_t threadsFor(Stage stage) const { return stage == HASHMAP_READY ? hashMapThreads : trieThreads; }
+
+    // Block until `stage` is ready, calling onProgress every `interval`.
+    // Returns false if loading failed.
+    bool waitFor(Stage stage, const std::function<void()>& onProgress = nullptr,
+                 std::chrono::milliseconds interval = std::chrono::milliseconds(250)) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!isReady(stage) && !failed.load()) {
+            changed.wait_for(lock, interval);
+            if (onProgress && !isReady(stage) && !failed.load()) {
+                lock.unlock();
+                onProgress();
+                lock.lock();
+            }
+        }
+        return isReady(stage);
+    }
+
+    // Visit every row parsed so far. Rows may still move while parsing, so
+    // `visit` must copy anything it keeps.
+    void scanParsed(const std::function<void(const Food&)>& visit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& food : foods) visit(food);
+    }
+
+    size_t rowsParsed() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return foods.size();
+    }
+
+    long long millis(Stage stage) const { return stageMs[stage].load(); }
+    long long indexMillis() const { return indexMs.load(); }
+
+    // One line for the menu, e.g. "Parsing CSV 42% (ETA 1.3 s)"
+    std::string status() {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+        if (failed.load()) {
+            out << "Failed to load " << path;
+        } else if (isDone()) {
+            out << "Ready (" << rowsIndexed[TRIE_READY].load() << " foods)";
+        } else if (isReady(HASHMAP_READY) && isReady(TRIE_READY)) {
+            out << "Building derived indexes";
+        } else if (!isReady(PARSED)) {
+            size_t total = totalBytes.load();
+            double fraction = total > 0 ? static_cast<double>(bytesRead.load()) / total : 0;
+            out << "Parsing CSV " << static_cast<int>(fraction * 100) << "% ("
+                << rowsParsed() << " rows";
+            double left = eta(fraction, elapsed);
+            if (left >= 0) out << ", ETA " << left << " s";
+            out << ")";
+        } else {
+            double rows = static_cast<double>(rowsParsed());
+            double buildElapsed = elapsed - stageMs[PARSED].load() / 1000.0;
+            double hashMapDone = rows > 0 ? rowsIndexed[HASHMAP_READY].load() / rows : 0;
+            double trieDone = rows > 0 ? rowsIndexed[TRIE_READY].load() / rows : 0;
+            out << "Building indexes: HashMap " << static_cast<int>(hashMapDone * 100)
+                << "%, Trie " << static_cast<int>(trieDone * 100) << "%";
+            double left = std::max(isReady(HASHMAP_READY) ? 0 : eta(hashMapDone, buildElapsed),
+                                   isReady(TRIE_READY) ? 0 : eta(trieDone, buildElapsed));
+            if (left >= 0 && hashMapDone > 0 && trieDone > 0) out << " (ETA " << left << " s)";
+        }
+        return out.str();
+    }
+};
+
+#endif // BACKGROUND_LOADER_H
@@ -0,0 +1,200 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <algorithm>
+#include <cstdlib>
+#include "Food.h"
+#include "HashMap.h"
+#include "Trie.h"
+#include "ScoreIndex.h"
+#include "BrandIndex.h"
+#include "OutputBuffer.h"
+#include "MealSpec.h"
+
+// Non-interactive query runner. Reads one command per line:
+//
+//   exact <name>                 exact match (also the default for bare lines)
+//   prefix <term>                names starting with term
+//   contains <term>              names containing term
+//   top <term>                   best-scoring names containing term (needs a ScoreIndex)
+//   brand <brand> [min score]    a brand's foods, best first (needs a BrandIndex)
+//   meal <name>:<grams>; ...     score a meal, grams default to 100
+//
+// and writes one JSON object (jsonl) or tab-separated rows (tsv) per result.
+// A JSON "count" is every match, not just the ones listed; top stops early
+// and cannot know that, so it reports how many foods it "scanned" instead.
+class BatchRunner {
+public:
+    enum class Format { JSONL, TSV };
+
+private:
+    const HashMap& hashMap;
+    const Trie& trie;
+    const ScoreIndex* scores;
+    const BrandIndex* brands;
+    OutputBuffer& out;
+    Format format;
+    size_t limit;
+    std::vector<const Food*> results; // reused by every search line
+
+    static std::string trim(const std::string& str) {
+        size_t first = str.find_first_not_of(" \t\r");
+        if (first == std::string::npos) return "";
+        size_t last = str.find_last_not_of(" \t\r");
+        return str.substr(first, last - first + 1);
+    }
+
+    void writeSearch(const std::string& type, const std::string& query,
+                     const std::vector<const Food*>& results, const char* countKey, size_t count) {
+        size_t shown = std::min(limit, results.size());
+        if (format == Format::JSONL) {
+            out.append("{\"type\":").appendJsonString(type)
+               .append(",\"query\":").appendJsonString(query)
+               .append(",\"").append(countKey).append("\":").append(count)
+               .append(",\"results\":[");
+            for (size_t i = 0; i < shown; i++) {
+                if (i > 0) out.append(',');
+                out.append("{\"name\":").appendJsonString(results[i]->name)
+                   .append(",\"score\":").append(results[i]->calculateScore())
+                   .append('}');
+            }
+            out.append("]}\n");
+            return;
+        }
+
+        if (shown == 0) {
+            out.append(type.c_str()).append('\t').appendTsvField(query).append("\t0\t\t\n");
+        }
+        for (size_t i = 0; i < shown; i++) {
+            out.append(type.c_str()).append('\t').appendTsvField(query)
+               .append('\t').append(i + 1)
+               .append('\t').appendTsvField(results[i]->name)
+               .append('\t').append(results[i]->calculateScore()).append('\n');
+        }
+    }
+
+    void runTop(const std::string& term) {
+        size_t scanned = 0;
+        if (scores != nullptr) {
+            ScoreIndex::Filter filter;
+            filter.contains = term;
+            scanned = scores->topByScore(filter, limit, results);
+        }
+        writeSearch("top", term, results, "scanned", scanned);
+    }
+
+    void runBrand(const std::string& argument) {
+        size_t space = argument.find(' ');
+        std::string brand = argument.substr(0, space);
+        int minScore = space == std::string::npos ? 1 : std::atoi(argument.c_str() + space + 1);
+        size_t qualifying = brands == nullptr ? 0 : brands->fromBrand(brand, minScore, limit, results);
+        writeSearch("brand", argument, results, "count", qualifying);
+    }
+
+    void runMeal(const std::string& spec) {
+        Food total;
+        total.name = "meal";
+        std::vector<MealSpecItem> items = parseMealSpec(spec);
+        std::vector<bool> found;
+
+        std::vector<const Food*> matches;
+        for (const auto& item : items) {
+            matches.clear();
+            hashMap.searchExact(item.name, matches);
+            if (!matches.empty()) {
+                total.accumulate(*matches[0], item.grams);
+            }
+            found.push_back(!matches.empty());
+        }
+
+        int score = total.calculateScore();
+        if (format == Format::JSONL) {
+            out.append("{\"type\":\"meal\",\"items\":[");
+            for (size_t i = 0; i < items.size(); i++) {
+                if (i > 0) out.append(',');
+                out.append("{\"name\":").appendJsonString(items[i].name)
+                   .append(",\"grams\":").appendFixed(items[i].grams, 1)
+                   .append(",\"found\":").append(found[i] ? "true" : "false")
+                   .append('}');
+            }
+            out.append("],\"kcal\":").appendFixed(total.kcal)
+               .append(",\"protein\":").appendFixed(total.protein)
+               .append(",\"fat\":").appendFixed(total.fat)
+               .append(",\"carbs\":").appendFixed(total.carbs)
+               .append(",\"sugar\":").appendFixed(total.sugar)
+               .append(",\"fiber\":").appendFixed(total.fiber)
+               .append(",\"satfat\":").appendFixed(total.satfat)
+               .append(",\"sodium\":").appendFixed(total.sodium)
+               .append(",\"score\":").append(score)
+               .append("}\n");
+            return;
+        }
+
+        out.append("meal\t").appendTsvField(spec)
+           .append('\t').append(score)
+           .append('\t').appendFixed(total.kcal)
+           .append('\t').appendFixed(total.protein)
+           .append('\t').appendFixed(total.fat)
+           .append('\t').appendFixed(total.carbs)
+           .append('\t').appendFixed(total.sugar)
+           .append('\t').appendFixed(total.fiber)
+           .append('\t').appendFixed(total.satfat)
+           .append('\t').appendFixed(total.sodium)
+           .append('\n');
+    }
+
+public:
+    BatchRunner(const HashMap& hm, const Trie& tr, OutputBuffer& output,
+                Format fmt = Format::JSONL, size_t maxResults = 10, const ScoreIndex* scoreIndex = nullptr,
+                const BrandIndex* brandIndex = nullptr)
+        : hashMap(hm), trie(tr), scores(scoreIndex), brands(brandIndex), out(output), format(fmt),
+          limit(maxResults) {}
+
+    // Run a single command line
+    void runLine(const std::string& rawLine) {
+        std::string line = trim(rawLine);
+        if (line.empty() || line[0] == '#') return;
+
+        size_t space = line.find(' ');
+        std::string command = line.substr(0, space);
+        std::string argument = space == std::string::npos ? "" : trim(line.substr(space + 1));
+
+        results.clear();
+        if (command == "exact") {
+            hashMap.searchExact(argument, results);
+            writeSearch("exact", argument, results, "count", results.size());
+        } else if (command == "prefix") {
+            trie.searchPrefix(argument, results);
+            writeSearch("prefix", argument, results, "count", results.size());
+        } else if (command == "contains") {
+            hashMap.searchContains(argument, results);
+            writeSearch("contains", argument, results, "count", results.size());
+        } else if (command == "top") {
+            runTop(argument);
+        } else if (command == "brand") {
+            runBrand(argument);
+        } else if (command == "meal") {
+            runMeal(argument);
+        } else {
+            hashMap.searchExact(line, results);
+            writeSearch("exact", line, results, "count", results.size());
+        }
+    }
+
+    // Run every line from the stream; returns the number of lines read
+    size_t run(std::istream& in) {
+        size_t lines = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            runLine(line);
+            lines++;
+        }
+        out.flush();
+        return lines;
+    }
+};
+
+#endif // BATCH_RUNNER_H
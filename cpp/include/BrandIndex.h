@@ -0,0 +1,158 @@
+#ifndef BRAND_INDEX_H
+#define BRAND_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include "Food.h"
+#include "FoodTable.h"
+
+// Foods grouped by brand, for "everything from KRAFT scoring 7 or more".
+// Branded names lead with the manufacturer, so a food's brand is the first
+// word of its name, compared case-insensitively. That is only a heuristic:
+// there is no brand dictionary, so multi-word brands are keyed by their
+// first word ("GENERAL MILLS" under "general", "TRADER JOE'S" under
+// "trader"), and unbranded names by theirs ("CHEDDAR CHEESE" under
+// "cheddar"). Brand keys are kept
+// sorted, and each brand's foods sit in one posting list ordered best score
+// first, so a brand query is a binary search plus a walk down its list that
+// stops at the first food below the minimum score. Like ScoreIndex it is a
+// snapshot: rebuild it when the data changes.
+class BrandIndex {
+public:
+    struct Brand {
+        std::string name; // as first seen in the data
+        size_t foods;
+    };
+
+private:
+    struct Posting {
+        int score;
+        int points; // positive minus negative points, before clamping
+        FoodId id;
+    };
+
+    std::vector<const Food*> foods; // by FoodId, in visiting order
+    std::vector<std::string> keys;  // lowercased, sorted
+    std::vector<std::string> names;
+    std::vector<size_t> start; // keys.size() + 1 offsets into postings
+    std::vector<Posting> postings;
+
+    static std::string lower(std::string_view text) {
+        std::string result(text);
+        for (char& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    // Score first, then the same tie-breaks as ScoreIndex
+    bool better(const Posting& a, const Posting& b) const {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.points != b.points) return a.points > b.points;
+        const Food& x = *foods[a.id];
+        const Food& y = *foods[b.id];
+        if (x.protein != y.protein) return x.protein > y.protein;
+        if (x.fiber != y.fiber) return x.fiber > y.fiber;
+        if (x.sodium != y.sodium) return x.sodium < y.sodium;
+        if (x.name != y.name) return x.name < y.name;
+        return a.id < b.id;
+    }
+
+    // Position of `key` in keys, or keys.size() if absent
+    size_t find(const std::string& key) const {
+        auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        if (it == keys.end() || *it != key) return keys.size();
+        return static_cast<size_t>(it - keys.begin());
+    }
+
+public:
+    // The brand part of a food name: up to the first space or comma
+    static std::string_view brandOf(std::string_view name) {
+        return name.substr(0, name.find_first_of(" ,"));
+    }
+
+    // The brand as it is compared: brandOf(name), lowercased
+    static std::string brandKey(std::string_view name) { return lower(brandOf(name)); }
+
+    template <typename Source>
+    void build(const Source& source) {
+        foods.clear();
+        keys.clear();
+        names.clear();
+        postings.clear();
+
+        // Number the brands in visiting order, then count foods per brand
+        std::unordered_map<std::string, size_t> brandIds;
+        std::vector<std::string> seenKeys;
+        std::vector<std::string> seenNames;
+        std::vector<size_t> brandOfFood;
+        source.forEach([&](const Food& food) {
+            std::string_view brand = brandOf(food.name);
+            auto inserted = brandIds.emplace(brandKey(food.name), seenKeys.size());
+            if (inserted.second) {
+                seenKeys.push_back(inserted.first->first);
+                seenNames.emplace_back(brand);
+            }
+            foods.push_back(&food);
+            brandOfFood.push_back(inserted.first->second);
+        });
+
+        std::vector<size_t> order(seenKeys.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return seenKeys[a] < seenKeys[b]; });
+        std::vector<size_t> rank(order.size());
+        for (size_t r = 0; r < order.size(); r++) {
+            rank[order[r]] = r;
+            keys.push_back(std::move(seenKeys[order[r]]));
+            names.push_back(std::move(seenNames[order[r]]));
+        }
+
+        // Counting sort of the foods into their brand's list
+        start.assign(keys.size() + 1, 0);
+        for (size_t brand : brandOfFood) start[rank[brand] + 1]++;
+        for (size_t b = 0; b < keys.size(); b++) start[b + 1] += start[b];
+        std::vector<size_t> next(start.begin(), start.end() - 1);
+        postings.resize(foods.size());
+        for (FoodId id = 0; id < foods.size(); id++) {
+            const Food& food = *foods[id];
+            // Same clamp as calculateScore, without scoring twice
+            int net = food.calculatePositivePoints() - food.calculateNegativePoints();
+            int score = std::min(10, std::max(1, 10 + net));
+            postings[next[rank[brandOfFood[id]]]++] = {score, net, id};
+        }
+        auto rankedAhead = [this](const Posting& a, const Posting& b) { return better(a, b); };
+        for (size_t b = 0; b < keys.size(); b++) {
+            std::sort(postings.begin() + start[b], postings.begin() + start[b + 1], rankedAhead);
+        }
+    }
+
+    size_t size() const { return foods.size(); }
+    size_t brandCount() const { return keys.size(); }
+
+    // Up to `n` foods of `brand` scoring at least `minScore`, best first,
+    // appended to `out`. Returns how many of the brand's foods qualify.
+    size_t fromBrand(const std::string& brand, int minScore, size_t n, std::vector<const Food*>& out) const {
+        size_t b = find(lower(brandOf(brand)));
+        if (b == keys.size()) return 0;
+        auto first = postings.begin() + start[b];
+        auto last = std::partition_point(first, postings.begin() + start[b + 1],
+                                         [minScore](const Posting& p) { return p.score >= minScore; });
+        size_t qualifying = static_cast<size_t>(last - first);
+        for (auto it = first; it != last && n > 0; ++it, n--) out.push_back(foods[it->id]);
+        return qualifying;
+    }
+
+    // Up to `n` brands starting with `prefix` (case-insensitive), in
+    // alphabetical order, appended to `out`
+    void brandsStartingWith(const std::string& prefix, size_t n, std::vector<Brand>& out) const {
+        std::string key = lower(prefix);
+        for (size_t b = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+             b < keys.size() && n > 0 && keys[b].compare(0, key.size(), key) == 0; b++, n--) {
+            out.push_back({names[b], start[b + 1] - start[b]});
+        }
+    }
+};
+
+#endif // BRAND_INDEX_H
@@ -12,7 +12,21 @@ class CSVReader {
 public:
     static std::vector<std::string> parseLine(const std::string& line) {
         std::vector<std::string> result;
-        std::string current;
+        parseLine(line, result);
+        return result;
+    }
+
+    // Split into `fields`, reusing its strings from the previous line so a
+    // steady stream of rows stops allocating once the buffers have grown
+    static void parseLine(const std::string& line, std::vector<std::string>& fields) {
+        size_t count = 0;
+        auto next = [&fields, &count]() -> std::string& {
+            if (count == fields.size()) fields.emplace_back();
+            std::string& field = fields[count++];
+            field.clear();
+            return field;
+        };
+        std::string* current = &next();
         bool inQuotes = false;
 
         for (size_t i = 0; i < line.length(); i++) {
@@ -21,15 +35,12 @@ public:
             if (c == '"') {
                 inQuotes = !inQuotes;
             } else if (c == ',' && !inQuotes) {
-                result.push_back(current);
-                current.clear();
+                current = &next();
             } else {
-                current += c;
+                *current += c;
             }
         }
-        result.push_back(current);
-        
-        return result;
+        fields.resize(count);
     }
 
     // Convert string to double, handling empty strings
@@ -42,6 +53,48 @@ public:
         }
     }
 
+    // Convert one data line into `food`, in place; false if it has too few
+    // fields. `fields` is scratch space kept by the caller across lines, so
+    // the only allocation per row is the name when it is too long for the
+    // small-string buffer.
+    static bool parseFood(const std::string& line, std::vector<std::string>& fields, Food& food) {
+        parseLine(line, fields);
+
+        // CSV format: name,kcal,protein,fat,carbs,sugar,fiber,satfat,sodium
+        if (fields.size() < 9) return false;
+        food.name.assign(fields[0]);
+        food.kcal = toDouble(fields[1]);
+        food.protein = toDouble(fields[2]);
+        food.fat = toDouble(fields[3]);
+        food.carbs = toDouble(fields[4]);
+        food.sugar = toDouble(fields[5]);
+        food.fiber = toDouble(fields[6]);
+        food.satfat = toDouble(fields[7]);
+        food.sodium = toDouble(fields[8]);
+        return true;
+    }
+
+    // Rough row count for reserve(): file size over the average length of
+    // the lines in the first 64 KiB. Leaves the stream rewound.
+    static size_t estimateRows(std::istream& file) {
+        file.seekg(0, std::ios::end);
+        std::streamoff size = file.tellg();
+        file.seekg(0);
+        if (size <= 0) return 0;
+
+        std::string line;
+        size_t sampledBytes = 0, sampledLines = 0;
+        while (sampledBytes < (1 << 16) && std::getline(file, line)) {
+            sampledBytes += line.size() + 1;
+            sampledLines++;
+        }
+        file.clear();
+        file.seekg(0);
+        if (sampledLines == 0) return 0;
+        // A little headroom so a slightly shorter tail does not regrow
+        return static_cast<size_t>(size / (sampledBytes / sampledLines) * 1.05) + 16;
+    }
+
     // Load foods from CSV file
     static std::vector<Food> loadFromCSV(const std::string& filename) {
         std::vector<Food> foods;
@@ -52,7 +105,9 @@ public:
             return foods;
         }
 
+        foods.reserve(estimateRows(file));
         std::string line;
+        std::vector<std::string> fields;
         bool firstLine = true;
 
         std::cout << "Loading data from " << filename << "..." << std::endl;
@@ -65,22 +120,9 @@ public:
 
             if (line.empty()) continue;
 
-            std::vector<std::string> fields = parseLine(line);
-            
-            // CSV format: name,kcal,protein,fat,carbs,sugar,fiber,satfat,sodium
-            if (fields.size() >= 9) {
-                Food food(
-                    fields[0],              // name
-                    toDouble(fields[1]),    // kcal
-                    toDouble(fields[2]),    // protein
-                    toDouble(fields[3]),    // fat
-                    toDouble(fields[4]),    // carbs
-                    toDouble(fields[5]),    // sugar
-                    toDouble(fields[6]),    // fiber
-                    toDouble(fields[7]),    // satfat
-                    toDouble(fields[8])     // sodium
-                );
-                foods.push_back(food);
+            foods.emplace_back();
+            if (!parseFood(line, fields, foods.back())) {
+                foods.pop_back();
             }
         }
 
@@ -0,0 +1,217 @@
+#ifndef COMPACT_NUTRIENTS_H
+#define COMPACT_NUTRIENTS_H
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include "Food.h"
+#include "FoodTable.h"
+
+// The nutrients as 16-bit fixed point, one column per field: kcal and
+// sodium in tenths, the rest in hundredths of a gram, which is the
+// precision of the branded sample dataset. Finer values (MealDataGen
+// writes kcal and sodium with two decimals) are rounded and counted as
+// inexact. That is 16 bytes a food instead of 64, so a scan over the
+// columns moves a quarter of the memory.
+//
+// A score only depends on which band bounds each value exceeds, so every
+// bound is turned into the largest fixed-point value that does not exceed
+// it under Food's own double arithmetic. For any value stored exactly the
+// points are then identical; values off the grid are rounded, and values
+// outside it saturate (negative to 0, too large or NaN to the top), which
+// keeps their points for every band in Food's tables. build() checks this
+// rather than assuming it: it scores every row both ways and keeps the
+// rows whose scores differ. Like DatasetAnalytics the columns are a
+// snapshot; rebuild them when the data changes.
+class CompactNutrients {
+public:
+    // Fixed-point steps per unit, in FoodTable::FIELDS order
+    static constexpr double SCALES[FoodTable::FIELD_COUNT] = {10, 100, 100, 100, 100, 100, 100, 10};
+
+    struct Mismatch {
+        const Food* food;
+        int expected; // Food::calculateScore
+        int actual;   // from the fixed-point columns
+    };
+
+    struct Verification {
+        size_t rows = 0;
+        size_t inexact = 0;    // rows with a value not stored exactly
+        size_t mismatches = 0; // rows whose score differs
+        std::vector<Mismatch> examples;
+        long long micros = 0;
+        bool ok() const { return mismatches == 0; }
+        // Every value stored exactly, so anything computed from the
+        // columns matches the doubles, not just the scores
+        bool exact() const { return inexact == 0 && mismatches == 0; }
+    };
+
+private:
+    static const size_t BLOCK = 1024;
+    static const size_t EXAMPLES = 10;
+
+    enum Column { KCAL, PROTEIN, FAT, CARBS, SUGAR, FIBER, SATFAT, SODIUM };
+
+    // Largest fixed-point value of each band that does not exceed it
+    struct Limits {
+        uint16_t energy[10];
+        uint16_t satfat[10];
+        uint16_t sugar[10];
+        uint16_t sodium[10];
+        uint16_t protein[5];
+        uint16_t fiber[5];
+    };
+
+    std::vector<uint16_t> columns[FoodTable::FIELD_COUNT];
+    Limits limits;
+    Verification verification;
+
+    static double decode(uint16_t value, int field) { return value / SCALES[field]; }
+
+    static uint16_t encode(double value, int field) {
+        if (std::isnan(value)) return UINT16_MAX;
+        double scaled = std::round(value * SCALES[field]);
+        if (scaled <= 0) return 0;
+        if (scaled >= UINT16_MAX) return UINT16_MAX;
+        return static_cast<uint16_t>(scaled);
+    }
+
+    // Binary search for the largest value whose decoded form, times
+    // `factor`, is still within `bound` (the same test as Food::bandPoints)
+    template <size_t N>
+    static void fillLimits(uint16_t (&out)[N], const double (&bounds)[N], int field, double factor = 1) {
+        for (size_t b = 0; b < N; b++) {
+            uint32_t low = 0, high = UINT16_MAX;
+            while (low < high) {
+                uint32_t middle = (low + high + 1) / 2;
+                if (decode(static_cast<uint16_t>(middle), field) * factor <= bounds[b]) {
+                    low = middle;
+                } else {
+                    high = middle - 1;
+                }
+            }
+            out[b] = static_cast<uint16_t>(low);
+        }
+    }
+
+    // Add to each of `points` how many limits its value exceeds; 16-bit
+    // counts keep the loop as wide as the values, so it vectorizes
+    template <size_t N>
+    static void addBands(uint16_t* points, const uint16_t* values, size_t count, const uint16_t (&bands)[N]) {
+        for (size_t i = 0; i < count; i++) {
+            uint16_t above = 0;
+            for (uint16_t limit : bands) above = static_cast<uint16_t>(above + (values[i] > limit));
+            points[i] = static_cast<uint16_t>(points[i] + above);
+        }
+    }
+
+    template <size_t N>
+    static int bandPoints(uint16_t value, const uint16_t (&bands)[N]) {
+        int points = 0;
+        for (uint16_t limit : bands) points += value > limit;
+        return points;
+    }
+
+public:
+    CompactNutrients() {
+        fillLimits(limits.energy, Food::ENERGY_KJ_BANDS, KCAL, 4.184);
+        fillLimits(limits.satfat, Food::SATFAT_BANDS, SATFAT);
+        fillLimits(limits.sugar, Food::SUGAR_BANDS, SUGAR);
+        fillLimits(limits.sodium, Food::SODIUM_BANDS, SODIUM);
+        fillLimits(limits.protein, Food::PROTEIN_BANDS, PROTEIN);
+        fillLimits(limits.fiber, Food::FIBER_BANDS, FIBER);
+    }
+
+    // Encode every food `source` visits through forEach, and verify each
+    // row's score against Food::calculateScore
+    template <typename Source>
+    void build(const Source& source) {
+        for (auto& column : columns) column.clear();
+        verification = Verification();
+        auto start = std::chrono::steady_clock::now();
+        source.forEach([&](const Food& food) {
+            bool exact = true;
+            for (int f = 0; f < FoodTable::FIELD_COUNT; f++) {
+                double value = food.*FoodTable::FIELDS[f];
+                uint16_t stored = encode(value, f);
+                exact = exact && decode(stored, f) == value;
+                columns[f].push_back(stored);
+            }
+            int expected = food.calculateScore();
+            int actual = score(verification.rows++);
+            verification.inexact += !exact;
+            if (expected != actual) {
+                verification.mismatches++;
+                if (verification.examples.size() < EXAMPLES) verification.examples.push_back({&food, expected, actual});
+            }
+        });
+        verification.micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                                  std::chrono::steady_clock::now() - start).count();
+    }
+
+    size_t size() const { return columns[0].size(); }
+
+    // What build() found, including up to EXAMPLES differing rows
+    const Verification& verified() const { return verification; }
+
+    // Score of the row added `row`-th, from the fixed-point columns
+    int score(size_t row) const {
+        int negative = bandPoints(columns[KCAL][row], limits.energy) + bandPoints(columns[SATFAT][row], limits.satfat) +
+                       bandPoints(columns[SUGAR][row], limits.sugar) + bandPoints(columns[SODIUM][row], limits.sodium);
+        int positive = bandPoints(columns[PROTEIN][row], limits.protein) + bandPoints(columns[FIBER][row], limits.fiber);
+        return std::min(10, std::max(1, 10 - (negative - positive)));
+    }
+
+    // Per-100g value of nutrient `field` (an index into FoodTable::FIELDS)
+    double value(size_t row, int field) const { return decode(columns[field][row], field); }
+
+    // Values of `field` for rows first..first + count into `out`
+    void values(int field, size_t first, size_t count, double* out) const {
+        const uint16_t* stored = columns[field].data() + first;
+        for (size_t i = 0; i < count; i++) out[i] = decode(stored[i], field);
+    }
+
+    // Scores of rows first..first + count into `out`, a block at a time
+    void scores(size_t first, size_t count, uint8_t* out) const {
+        uint16_t negative[BLOCK];
+        uint16_t positive[BLOCK];
+        for (size_t done = 0; done < count; done += BLOCK) {
+            size_t rows = std::min(BLOCK, count - done);
+            size_t row = first + done;
+            std::fill(negative, negative + rows, 0);
+            std::fill(positive, positive + rows, 0);
+            addBands(negative, columns[KCAL].data() + row, rows, limits.energy);
+            addBands(negative, columns[SATFAT].data() + row, rows, limits.satfat);
+            addBands(negative, columns[SUGAR].data() + row, rows, limits.sugar);
+            addBands(negative, columns[SODIUM].data() + row, rows, limits.sodium);
+            addBands(positive, columns[PROTEIN].data() + row, rows, limits.protein);
+            addBands(positive, columns[FIBER].data() + row, rows, limits.fiber);
+            for (size_t i = 0; i < rows; i++) {
+                int score = 10 + positive[i] - negative[i];
+                out[done + i] = static_cast<uint8_t>(std::min(10, std::max(1, score)));
+            }
+        }
+    }
+
+    // Foods per score 1..10 from one blocked pass over the columns
+    void scoreCounts(uint64_t (&counts)[11]) const {
+        std::fill(counts, counts + 11, 0);
+        uint8_t block[BLOCK];
+        for (size_t first = 0; first < size(); first += BLOCK) {
+            size_t count = std::min(BLOCK, size() - first);
+            scores(first, count, block);
+            for (size_t i = 0; i < count; i++) counts[block[i]]++;
+        }
+    }
+
+    // Bytes held by the columns
+    size_t bytesUsed() const {
+        size_t bytes = 0;
+        for (const auto& column : columns) bytes += column.capacity() * sizeof(uint16_t);
+        return bytes;
+    }
+};
+
+#endif // COMPACT_NUTRIENTS_H
@@ -0,0 +1,79 @@
+#ifndef DATA_SNAPSHOT_H
+#define DATA_SNAPSHOT_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include "HashMap.h"
+#include "Trie.h"
+#include "ScoreIndex.h"
+#include "BrandIndex.h"
+#include "DuplicateIndex.h"
+#include "BackgroundLoader.h"
+
+// Build timings reported by /stats
+struct LoadStats {
+    size_t foods = 0;
+    long long hashMapBuildMs = 0;
+    long long trieBuildMs = 0;
+    long long indexBuildMs = 0; // both builds together (they run concurrently)
+};
+
+// One complete version of the dataset: the parsed rows, both indexes over
+// them, the foods grouped by score and by brand, and the near-duplicate
+// clusters. It is built off to the side and never changes afterwards, so it
+// can be published through a SnapshotCell and read without locks. The
+// clusters cost more than the rest, so load() returns without them: the
+// loader builds them as its last stage, while the snapshot is already in
+// use, and nearDuplicatesReady() says when they can be read.
+class DataSnapshot {
+public:
+    HashMap hashMap;
+    Trie trie;
+    ScoreIndex scores;
+    BrandIndex brands;
+    LoadStats stats;
+    unsigned long long version = 0;
+
+private:
+    DuplicateIndex duplicates;              // written by the loader thread until DERIVED_READY
+    BackgroundLoader loader{hashMap, trie}; // owns the rows the indexes point into; joined first
+
+    DataSnapshot() = default;
+
+public:
+    DataSnapshot(const DataSnapshot&) = delete;
+    DataSnapshot& operator=(const DataSnapshot&) = delete;
+
+    // Parse `path`, apply `deltas` and build both indexes; nullptr if
+    // nothing could be loaded. The clusters are still being built when it
+    // returns.
+    static std::unique_ptr<DataSnapshot> load(const std::string& path, unsigned long long version,
+                                              const std::vector<std::string>& deltas = {}) {
+        std::unique_ptr<DataSnapshot> snapshot(new DataSnapshot());
+        BackgroundLoader& loader = snapshot->loader;
+        DataSnapshot* built = snapshot.get();
+        loader.derive([built]() { built->duplicates.build(built->hashMap); });
+        loader.start(path, deltas);
+        if (!loader.waitFor(BackgroundLoader::HASHMAP_READY) ||
+            !loader.waitFor(BackgroundLoader::TRIE_READY)) {
+            return nullptr;
+        }
+        snapshot->scores.build(snapshot->hashMap);
+        snapshot->brands.build(snapshot->hashMap);
+        snapshot->version = version;
+        snapshot->stats.foods = loader.rowsParsed();
+        snapshot->stats.hashMapBuildMs = loader.millis(BackgroundLoader::HASHMAP_READY);
+        snapshot->stats.trieBuildMs = loader.millis(BackgroundLoader::TRIE_READY);
+        snapshot->stats.indexBuildMs = loader.indexMillis();
+        return snapshot;
+    }
+
+    long long parseMs() const { return loader.millis(BackgroundLoader::PARSED); }
+
+    // The near-duplicate clusters; only valid once nearDuplicatesReady()
+    bool nearDuplicatesReady() const { return loader.isReady(BackgroundLoader::DERIVED_READY); }
+    const DuplicateIndex& nearDuplicates() const { return duplicates; }
+};
+
+#endif // DATA_SNAPSHOT_H
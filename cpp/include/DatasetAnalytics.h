@@ -0,0 +1,267 @@
+#ifndef DATASET_ANALYTICS_H
+#define DATASET_ANALYTICS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include "Food.h"
+#include "FoodTable.h"
+#include "QuantileSketch.h"
+#include "BrandIndex.h"
+#include "CompactNutrients.h"
+
+// Dataset-level figures: the score distribution, percentiles of every
+// nutrient, how many foods are "high" under the FSA front-of-pack
+// thresholds, and counts and mean scores per brand (BrandIndex::brandKey,
+// so case-insensitive like the brand index; shown as first spelled).
+//
+// build() copies the nutrients into one column per field and the first
+// words into a column of dictionary ids, so run() never touches a Food or
+// a string. run() is one pass over the columns: each thread takes a range
+// of rows and works through it in blocks, counting score bands with
+// branch-free loops over contiguous doubles (which the compiler
+// vectorizes), then merges its partial counts and QuantileSketches. Given
+// CompactNutrients built from the same source, the pass reads only its
+// 16-bit columns: the scores come from its bands, and the FSA counts and
+// sketches from its values decoded a block at a time. Like
+// NutrientIndex the columns are a snapshot; rebuild them when the data
+// changes.
+class DatasetAnalytics {
+public:
+    // FSA "high" per 100g: fat, saturates, sugars and salt (1.5g of salt
+    // is 600mg of sodium)
+    static constexpr double HIGH_FAT = 17.5;
+    static constexpr double HIGH_SATFAT = 5;
+    static constexpr double HIGH_SUGAR = 22.5;
+    static constexpr double HIGH_SODIUM = 600;
+
+    struct Brand {
+        std::string token;
+        uint64_t foods = 0;
+        uint64_t scoreSum = 0;
+        double meanScore() const { return foods > 0 ? static_cast<double>(scoreSum) / foods : 0; }
+    };
+
+    struct Result {
+        uint64_t foods = 0;
+        uint64_t scores[11] = {};                         // foods per score 1..10
+        QuantileSketch nutrients[FoodTable::FIELD_COUNT]; // in FoodTable::FIELDS order
+        uint64_t highFat = 0;
+        uint64_t highSatfat = 0;
+        uint64_t highSugar = 0;
+        uint64_t highSodium = 0;
+        uint64_t highAny = 0;
+        std::vector<Brand> brands; // most foods first
+        size_t threads = 0;
+        long long micros = 0;
+    };
+
+private:
+    static const size_t BLOCK = 1024;
+
+    // Column positions in FoodTable::FIELDS order
+    enum Column { KCAL, PROTEIN, FAT, CARBS, SUGAR, FIBER, SATFAT, SODIUM };
+
+    std::vector<double> columns[FoodTable::FIELD_COUNT];
+    std::vector<uint32_t> brandIds;
+    std::vector<std::string> brandTokens;
+
+    struct Partial {
+        Result result;
+        std::vector<uint64_t> brandFoods;
+        std::vector<uint64_t> brandScores;
+    };
+
+    // Add to each of `points` how many `bands` its value exceeds, counting
+    // NaN as above every band like Food does. Points are kept as doubles
+    // because plain x86-64 has no 64-bit integer select, and the loop only
+    // vectorizes when the counts are as wide as the values.
+    template <size_t N>
+    static void addBands(double* points, const double* values, size_t count, const double (&bands)[N],
+                         double scale = 1) {
+        for (size_t i = 0; i < count; i++) {
+            double value = values[i] * scale;
+            double above = 0;
+            for (double bound : bands) above += !(value <= bound) ? 1.0 : 0.0;
+            points[i] += above;
+        }
+    }
+
+    // Negative and positive points of rows first..first + count, with the
+    // same bands and energy conversion as Food's
+    void points(size_t first, size_t count, double* negative, double* positive) const {
+        std::fill(negative, negative + count, 0.0);
+        std::fill(positive, positive + count, 0.0);
+        addBands(negative, columns[KCAL].data() + first, count, Food::ENERGY_KJ_BANDS, 4.184);
+        addBands(negative, columns[SATFAT].data() + first, count, Food::SATFAT_BANDS);
+        addBands(negative, columns[SUGAR].data() + first, count, Food::SUGAR_BANDS);
+        addBands(negative, columns[SODIUM].data() + first, count, Food::SODIUM_BANDS);
+        addBands(positive, columns[PROTEIN].data() + first, count, Food::PROTEIN_BANDS);
+        addBands(positive, columns[FIBER].data() + first, count, Food::FIBER_BANDS);
+    }
+
+    void scan(Partial& partial, size_t begin, size_t end, const CompactNutrients* compact) const {
+        Result& result = partial.result;
+        double negative[BLOCK];
+        double positive[BLOCK];
+        uint8_t compactScores[BLOCK];
+        std::vector<double> decoded(compact ? FoodTable::FIELD_COUNT * BLOCK : 0);
+        for (size_t first = begin; first < end; first += BLOCK) {
+            size_t count = std::min(BLOCK, end - first);
+            const double* values[FoodTable::FIELD_COUNT];
+            for (int f = 0; f < FoodTable::FIELD_COUNT; f++) {
+                if (compact) {
+                    values[f] = decoded.data() + f * BLOCK;
+                    compact->values(f, first, count, decoded.data() + f * BLOCK);
+                } else {
+                    values[f] = columns[f].data() + first;
+                }
+            }
+            const double* fat = values[FAT];
+            const double* sugar = values[SUGAR];
+            const double* satfat = values[SATFAT];
+            const double* sodium = values[SODIUM];
+            const uint32_t* brands = brandIds.data() + first;
+
+            if (compact) {
+                compact->scores(first, count, compactScores);
+            } else {
+                points(first, count, negative, positive);
+            }
+            for (size_t i = 0; i < count; i++) {
+                int score = compact ? compactScores[i]
+                                    : static_cast<int>(std::min(10.0, std::max(1.0, 10 + positive[i] - negative[i])));
+                result.scores[score]++;
+                partial.brandFoods[brands[i]]++;
+                partial.brandScores[brands[i]] += static_cast<uint64_t>(score);
+            }
+
+            uint64_t highFat = 0, highSatfat = 0, highSugar = 0, highSodium = 0, highAny = 0;
+            for (size_t i = 0; i < count; i++) {
+                bool isFat = fat[i] > HIGH_FAT;
+                bool isSatfat = satfat[i] > HIGH_SATFAT;
+                bool isSugar = sugar[i] > HIGH_SUGAR;
+                bool isSodium = sodium[i] > HIGH_SODIUM;
+                highFat += isFat;
+                highSatfat += isSatfat;
+                highSugar += isSugar;
+                highSodium += isSodium;
+                highAny += isFat | isSatfat | isSugar | isSodium;
+            }
+            result.highFat += highFat;
+            result.highSatfat += highSatfat;
+            result.highSugar += highSugar;
+            result.highSodium += highSodium;
+            result.highAny += highAny;
+
+            for (int f = 0; f < FoodTable::FIELD_COUNT; f++) {
+                for (size_t i = 0; i < count; i++) result.nutrients[f].add(values[f][i]);
+            }
+        }
+        result.foods += end - begin;
+    }
+
+    static void merge(Partial& into, const Partial& from) {
+        Result& a = into.result;
+        const Result& b = from.result;
+        a.foods += b.foods;
+        for (int s = 0; s <= 10; s++) a.scores[s] += b.scores[s];
+        for (int f = 0; f < FoodTable::FIELD_COUNT; f++) a.nutrients[f].merge(b.nutrients[f]);
+        a.highFat += b.highFat;
+        a.highSatfat += b.highSatfat;
+        a.highSugar += b.highSugar;
+        a.highSodium += b.highSodium;
+        a.highAny += b.highAny;
+        for (size_t id = 0; id < from.brandFoods.size(); id++) {
+            into.brandFoods[id] += from.brandFoods[id];
+            into.brandScores[id] += from.brandScores[id];
+        }
+    }
+
+public:
+    // Copy every food `source` visits through forEach into the columns
+    template <typename Source>
+    void build(const Source& source) {
+        for (auto& column : columns) column.clear();
+        brandIds.clear();
+        brandTokens.clear();
+        std::unordered_map<std::string, uint32_t> tokenIds;
+        source.forEach([&](const Food& food) {
+            for (int f = 0; f < FoodTable::FIELD_COUNT; f++) columns[f].push_back(food.*FoodTable::FIELDS[f]);
+            uint32_t next = static_cast<uint32_t>(brandTokens.size());
+            auto inserted = tokenIds.emplace(BrandIndex::brandKey(food.name), next);
+            if (inserted.second) brandTokens.emplace_back(BrandIndex::brandOf(food.name));
+            brandIds.push_back(inserted.first->second);
+        });
+    }
+
+    size_t size() const { return brandIds.size(); }
+
+    // Bytes held by the nutrient columns
+    size_t nutrientBytes() const {
+        size_t bytes = 0;
+        for (const auto& column : columns) bytes += column.capacity() * sizeof(double);
+        return bytes;
+    }
+
+    // Foods per score 1..10 alone, from one blocked pass on this thread
+    // (the score part of run(), for comparing layouts)
+    void scoreCounts(uint64_t (&counts)[11]) const {
+        std::fill(counts, counts + 11, 0);
+        double negative[BLOCK];
+        double positive[BLOCK];
+        for (size_t first = 0; first < size(); first += BLOCK) {
+            size_t count = std::min(BLOCK, size() - first);
+            points(first, count, negative, positive);
+            for (size_t i = 0; i < count; i++) {
+                counts[static_cast<int>(std::min(10.0, std::max(1.0, 10 + positive[i] - negative[i])))]++;
+            }
+        }
+    }
+
+    // Analyse every row on `threads` threads, keeping the `topBrands`
+    // largest groups; scores come from `compact` when it has every row
+    Result run(size_t threads = std::thread::hardware_concurrency(), size_t topBrands = 10,
+               const CompactNutrients* compact = nullptr) const {
+        auto start = std::chrono::steady_clock::now();
+        if (compact && compact->size() != size()) compact = nullptr;
+        threads = std::max<size_t>(1, std::min(threads, size() / BLOCK + 1));
+        std::vector<Partial> partials(threads);
+        for (auto& partial : partials) {
+            partial.brandFoods.assign(brandTokens.size(), 0);
+            partial.brandScores.assign(brandTokens.size(), 0);
+        }
+        auto work = [&](size_t t) {
+            scan(partials[t], size() * t / threads, size() * (t + 1) / threads, compact);
+        };
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; t++) workers.emplace_back(work, t);
+        work(0);
+        for (auto& worker : workers) worker.join();
+        for (size_t t = 1; t < threads; t++) merge(partials[0], partials[t]);
+
+        Result result = std::move(partials[0].result);
+        std::vector<uint32_t> order(brandTokens.size());
+        for (uint32_t id = 0; id < order.size(); id++) order[id] = id;
+        const Partial& totals = partials[0];
+        size_t kept = std::min(topBrands, order.size());
+        std::partial_sort(order.begin(), order.begin() + kept, order.end(), [&](uint32_t a, uint32_t b) {
+            if (totals.brandFoods[a] != totals.brandFoods[b]) return totals.brandFoods[a] > totals.brandFoods[b];
+            return brandTokens[a] < brandTokens[b];
+        });
+        for (size_t i = 0; i < kept; i++) {
+            uint32_t id = order[i];
+            result.brands.push_back({brandTokens[id], totals.brandFoods[id], totals.brandScores[id]});
+        }
+        result.threads = threads;
+        result.micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+};
+
+#endif // DATASET_ANALYTICS_H
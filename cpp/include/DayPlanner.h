@@ -0,0 +1,255 @@
+#ifndef DAY_PLANNER_H
+#define DAY_PLANNER_H
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include "Food.h"
+#include "NutrientIndex.h"
+
+// Builds a day of meals (breakfast, lunch, dinner and snacks) that hits an
+// energy target and a protein/fat/carb split while scoring as well as it
+// can. Foods come from a pool drawn from the NutrientIndex, and the plan
+// is found by simulated annealing: each move swaps one item's food or
+// changes its serving, and only that meal's totals and the day totals are
+// updated, so a move costs one meal rescore. Several restarts run on all
+// cores; each has its own seed derived from Settings::seed, and the best
+// is picked by value and then by restart number, so the same seed always
+// gives the same plan whatever the thread count.
+class DayPlanner {
+public:
+    struct Targets {
+        double kcal = 2000;
+        double proteinShare = 0.20; // shares of the energy
+        double fatShare = 0.30;
+        double carbsShare = 0.50;
+        double tolerance = 0.10; // allowed relative miss on each target
+
+        double protein() const { return kcal * proteinShare / 4; }
+        double fat() const { return kcal * fatShare / 9; }
+        double carbs() const { return kcal * carbsShare / 4; }
+    };
+
+    struct Slot {
+        const char* name;
+        double share; // of the day's energy
+        size_t items;
+    };
+    static const size_t SLOT_COUNT = 4;
+    static constexpr Slot SLOTS[SLOT_COUNT] = {
+        {"Breakfast", 0.25, 3}, {"Lunch", 0.30, 3}, {"Dinner", 0.30, 3}, {"Snacks", 0.15, 2}};
+
+    struct Settings {
+        unsigned long long seed = 1;
+        size_t restarts = 8;
+        size_t iterations = 150000; // moves per restart
+        size_t threads = std::thread::hardware_concurrency();
+    };
+
+    struct Item {
+        const Food* food;
+        double grams;
+    };
+
+    struct PlannedMeal {
+        std::vector<Item> items;
+        Food total;
+        int score = 0;
+    };
+
+    struct Plan {
+        std::vector<PlannedMeal> meals; // one per slot, empty if no foods qualified
+        Food total;
+        int score = 0;          // summed meal scores
+        bool onTarget = false;  // every day target within tolerance
+        size_t poolSize = 0;
+        long long millis = 0;
+    };
+
+    // The foods plans are built from: moderate energy density and low
+    // sugar, saturated fat and sodium per 100g
+    static std::vector<NutrientIndex::Range> poolRanges() {
+        return {{&Food::kcal, 40, 500}, {&Food::sugar, 0, 15}, {&Food::satfat, 0, 5}, {&Food::sodium, 0, 600}};
+    }
+
+private:
+    // Points lost per unit of relative miss beyond the tolerance
+    static constexpr double DAY_WEIGHT = 100;
+    static constexpr double MEAL_WEIGHT = 20;
+    // How far a meal's energy may stray from its slot's share
+    static constexpr double MEAL_TOLERANCE = 0.25;
+    static constexpr double MIN_GRAMS = 10;
+    static constexpr double MAX_GRAMS = 400;
+    static constexpr double GRAM_STEP = 5;
+    static constexpr double START_TEMPERATURE = 3;
+    static constexpr double END_TEMPERATURE = 0.05;
+
+    struct State {
+        std::vector<Item> items; // slot by slot
+        Food meals[SLOT_COUNT];
+        double mealValue[SLOT_COUNT];
+        Food day;
+        double dayPenalty = 0;
+        double value = 0;
+    };
+
+    const NutrientIndex& index;
+    Targets targets;
+    std::vector<const Food*> pool;
+    std::vector<size_t> slotOf; // slot of each flat item
+
+    static double miss(double actual, double target, double tolerance) {
+        if (target <= 0) return 0;
+        return std::max(0.0, std::fabs(actual - target) / target - tolerance);
+    }
+
+    static double snap(double grams) {
+        grams = std::round(grams / GRAM_STEP) * GRAM_STEP;
+        return std::min(MAX_GRAMS, std::max(MIN_GRAMS, grams));
+    }
+
+    double mealValueOf(size_t slot, const Food& meal) const {
+        return meal.calculateScore() - MEAL_WEIGHT * miss(meal.kcal, targets.kcal * SLOTS[slot].share, MEAL_TOLERANCE);
+    }
+
+    double dayPenaltyOf(const Food& day) const {
+        return DAY_WEIGHT * (miss(day.kcal, targets.kcal, targets.tolerance) +
+                             miss(day.protein, targets.protein(), targets.tolerance) +
+                             miss(day.fat, targets.fat(), targets.tolerance) +
+                             miss(day.carbs, targets.carbs(), targets.tolerance));
+    }
+
+    // Serving of `food` that supplies `kcal`
+    static double gramsFor(const Food& food, double kcal) {
+        return snap(food.kcal > 0 ? kcal * 100 / food.kcal : MIN_GRAMS);
+    }
+
+    // Recompute every total of `state` from its items
+    void total(State& state) const {
+        state.day = Food();
+        for (size_t s = 0; s < SLOT_COUNT; s++) state.meals[s] = Food();
+        for (size_t i = 0; i < state.items.size(); i++) {
+            state.meals[slotOf[i]].accumulate(*state.items[i].food, state.items[i].grams);
+        }
+        state.value = 0;
+        for (size_t s = 0; s < SLOT_COUNT; s++) {
+            state.day.accumulate(state.meals[s]);
+            state.mealValue[s] = mealValueOf(s, state.meals[s]);
+            state.value += state.mealValue[s];
+        }
+        state.dayPenalty = dayPenaltyOf(state.day);
+        state.value -= state.dayPenalty;
+    }
+
+    State anneal(size_t restart, unsigned long long seed, size_t iterations) const {
+        std::seed_seq sequence{seed, static_cast<unsigned long long>(restart)};
+        std::mt19937_64 rng(sequence);
+        auto below = [&rng](size_t n) { return static_cast<size_t>(rng() % n); };
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+        // Start with random foods sized to their slot's energy share
+        State state;
+        for (size_t i = 0; i < slotOf.size(); i++) {
+            const Food* food = pool[below(pool.size())];
+            const Slot& slot = SLOTS[slotOf[i]];
+            state.items.push_back({food, gramsFor(*food, targets.kcal * slot.share / slot.items)});
+        }
+        total(state);
+        State best = state;
+
+        for (size_t step = 0; step < iterations; step++) {
+            double temperature = START_TEMPERATURE *
+                std::pow(END_TEMPERATURE / START_TEMPERATURE, static_cast<double>(step) / iterations);
+            size_t i = below(state.items.size());
+            size_t slot = slotOf[i];
+            Item before = state.items[i];
+            Item after = before;
+            if (rng() & 1) {
+                // A different food with the same energy
+                after.food = pool[below(pool.size())];
+                after.grams = gramsFor(*after.food, before.food->kcal * before.grams / 100);
+            } else {
+                double change = GRAM_STEP * static_cast<double>(1 + below(5));
+                after.grams = snap(before.grams + ((rng() & 1) ? change : -change));
+            }
+            if (after.food == before.food && after.grams == before.grams) continue;
+
+            Food meal = state.meals[slot];
+            meal.accumulate(*before.food, -before.grams);
+            meal.accumulate(*after.food, after.grams);
+            Food day = state.day;
+            day.accumulate(*before.food, -before.grams);
+            day.accumulate(*after.food, after.grams);
+            double mealValue = mealValueOf(slot, meal);
+            double dayPenalty = dayPenaltyOf(day);
+            double value = state.value - state.mealValue[slot] + mealValue + state.dayPenalty - dayPenalty;
+
+            double gain = value - state.value;
+            if (gain < 0 && unit(rng) >= std::exp(gain / temperature)) continue;
+            state.items[i] = after;
+            state.meals[slot] = meal;
+            state.mealValue[slot] = mealValue;
+            state.day = day;
+            state.dayPenalty = dayPenalty;
+            state.value = value;
+            if (value > best.value) best = state;
+        }
+        // Running sums drift a little over many moves
+        total(best);
+        return best;
+    }
+
+public:
+    explicit DayPlanner(const NutrientIndex& nutrients) : index(nutrients) {}
+
+    Plan plan(const Targets& dayTargets, const Settings& settings) {
+        auto start = std::chrono::steady_clock::now();
+        targets = dayTargets;
+        pool.clear();
+        index.query(poolRanges(), pool);
+        slotOf.clear();
+        for (size_t s = 0; s < SLOT_COUNT; s++) slotOf.insert(slotOf.end(), SLOTS[s].items, s);
+
+        Plan result;
+        result.poolSize = pool.size();
+        if (pool.empty() || settings.restarts == 0) return result;
+
+        std::vector<State> finished(settings.restarts);
+        std::atomic<size_t> next{0};
+        auto work = [&]() {
+            size_t restart;
+            while ((restart = next.fetch_add(1)) < settings.restarts) {
+                finished[restart] = anneal(restart, settings.seed, settings.iterations);
+            }
+        };
+        size_t threads = std::max<size_t>(1, std::min(settings.threads, settings.restarts));
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; t++) workers.emplace_back(work);
+        work();
+        for (auto& worker : workers) worker.join();
+
+        size_t chosen = 0;
+        for (size_t r = 1; r < finished.size(); r++) {
+            if (finished[r].value > finished[chosen].value) chosen = r;
+        }
+        const State& best = finished[chosen];
+        result.meals.resize(SLOT_COUNT);
+        for (size_t i = 0; i < best.items.size(); i++) result.meals[slotOf[i]].items.push_back(best.items[i]);
+        for (size_t s = 0; s < SLOT_COUNT; s++) {
+            result.meals[s].total = best.meals[s];
+            result.meals[s].score = best.meals[s].calculateScore();
+            result.score += result.meals[s].score;
+        }
+        result.total = best.day;
+        result.onTarget = best.dayPenalty == 0;
+        result.millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+};
+
+#endif // DAY_PLANNER_H
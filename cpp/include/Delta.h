@@ -0,0 +1,106 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cctype>
+#include "Food.h"
+#include "CSVReader.h"
+
+// One row of a delta file: replace every food with this name by one row
+// (or add it), or remove every food with it
+struct FoodDelta {
+    Food food;
+    bool remove = false;
+};
+
+// What applying a delta did to one index
+struct DeltaResult {
+    size_t updated = 0;
+    size_t added = 0;
+    size_t removed = 0;
+    size_t collapsed = 0; // same-name rows an upsert dropped beyond the one it replaced
+};
+
+// Delta CSVs have the same columns as the dataset plus an optional tenth,
+// `op`: "upsert" (the default when missing or empty) or "delete", in any
+// case. Rows are keyed by name, case-insensitively, and applied in file
+// order, so a delta can be applied to the built indexes without reloading
+// the full file. The dataset has no stable id, so an upsert replaces every
+// row sharing the name with one; DeltaResult::collapsed counts the others.
+// A file with an unknown op, or an upsert missing a nutrient, is rejected
+// whole rather than applied in part.
+class DeltaCSV {
+    static std::string lower(const std::string& text) {
+        std::string result = text;
+        for (char& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+public:
+    // Append the rows of `filename` to `deltas`; false if it cannot be read
+    static bool load(const std::string& filename, std::vector<FoodDelta>& deltas) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open delta file " << filename << std::endl;
+            return false;
+        }
+
+        std::vector<FoodDelta> rows;
+        std::vector<std::string> fields;
+        std::string line;
+        size_t lineNumber = 1;
+        std::getline(file, line); // skip header
+        while (std::getline(file, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            FoodDelta delta;
+            CSVReader::parseLine(line, fields);
+            std::string op = fields.size() >= 10 ? lower(fields[9]) : "";
+            if (op == "delete") {
+                // Only the name matters for a delete
+                delta.food.name = fields[0];
+                delta.remove = true;
+            } else if (op.empty() || op == "upsert") {
+                bool complete = fields.size() >= 9;
+                for (size_t i = 1; complete && i < 9; i++) complete = !fields[i].empty();
+                if (!complete) {
+                    std::cerr << "Error: " << filename << ":" << lineNumber
+                              << ": an upsert needs all 8 nutrients" << std::endl;
+                    return false;
+                }
+                CSVReader::parseFood(line, fields, delta.food);
+            } else {
+                std::cerr << "Error: " << filename << ":" << lineNumber << ": unknown op '" << fields[9]
+                          << "' (expected upsert or delete)" << std::endl;
+                return false;
+            }
+            rows.push_back(std::move(delta));
+        }
+        deltas.insert(deltas.end(), rows.begin(), rows.end());
+        return true;
+    }
+
+    // Apply `deltas` in order to a HashMap or Trie
+    template <typename Index>
+    static DeltaResult apply(Index& index, const std::vector<FoodDelta>& deltas) {
+        DeltaResult result;
+        for (const auto& delta : deltas) {
+            if (delta.remove) {
+                result.removed += index.remove(delta.food.name);
+            } else if (size_t replaced = index.upsert(delta.food)) {
+                result.updated++;
+                result.collapsed += replaced - 1;
+            } else {
+                result.added++;
+            }
+        }
+        return result;
+    }
+};
+
+#endif // DELTA_H
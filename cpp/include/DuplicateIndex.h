@@ -0,0 +1,357 @@
+#ifndef DUPLICATE_INDEX_H
+#define DUPLICATE_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include "Food.h"
+#include "FoodTable.h"
+
+// Clusters of near-duplicate foods: rows whose names share most of their
+// letter trigrams and whose nutrients agree closely, such as "CHEDDAR
+// CHEESE" and "CHEDDAR CHEESE, SHARP" from the same label, or the same name
+// listed again with slightly different values.
+//
+// Branded data repeats names heavily, so the work is done per distinct
+// name. Each name gets a MinHash signature of HASHES 16-bit values, cut
+// into BANDS bands of ROWS values; names that agree on a whole band land in
+// the same LSH bucket, and bucket neighbours whose signatures agree on at
+// least `minSimilarity` of their values become candidate name pairs. The
+// foods under each name are kept sorted by energy, so nutrients are only
+// compared between foods of the same or a candidate name whose energy is
+// close, up to `window` foods each. Matching pairs are joined with
+// union-find, and each cluster is represented by its shortest name.
+//
+// Signatures, bands and comparisons all run on `threads` threads. Like
+// ScoreIndex it is a snapshot: rebuild it when the data changes.
+class DuplicateIndex {
+public:
+    static const size_t BANDS = 16;
+    static const size_t ROWS = 3; // so names sharing half their trigrams meet in ~90% of cases
+    static const size_t HASHES = BANDS * ROWS;
+
+    struct Settings {
+        double minSimilarity = 0.5; // estimated trigram Jaccard of the names
+        double maxDistance = 0.1;   // largest relative difference of any nutrient
+        size_t window = 8;
+        size_t threads = std::thread::hardware_concurrency();
+    };
+
+    struct Stats {
+        size_t foods = 0;
+        size_t names = 0;      // distinct names
+        size_t namePairs = 0;  // similar distinct names
+        size_t compared = 0;   // food pairs whose nutrients were compared
+        size_t duplicates = 0; // foods that are not their cluster's representative
+        size_t clusters = 0;   // clusters of two or more foods
+        size_t largest = 0;
+        long long millis = 0;
+    };
+
+    struct Cluster {
+        const Food* representative;
+        size_t size;
+    };
+
+private:
+    struct Pair {
+        uint32_t a;
+        uint32_t b;
+    };
+
+    // Pairs and counts found by one worker
+    struct Found {
+        std::vector<Pair> pairs;
+        size_t compared = 0;
+    };
+
+    std::vector<Cluster> clusters;
+    std::unordered_map<const Food*, uint32_t> clusterOf; // foods in clusters of two or more
+    Stats lastStats;
+
+    // Multipliers for the HASHES hash functions, fixed so that the same
+    // data always gives the same clusters
+    static uint32_t multiplier(size_t i) {
+        uint64_t x = 0x9E3779B97F4A7C15ull * (i + 1);
+        x = (x ^ (x >> 31)) * 0xBF58476D1CE4E5B9ull;
+        return static_cast<uint32_t>(x >> 32) | 1u;
+    }
+
+    // MinHash of the lowercased letter trigrams of `name`, padded with a
+    // space at each end
+    static void sign(const std::string& name, const uint32_t (&multipliers)[HASHES], uint16_t* signature) {
+        std::fill(signature, signature + HASHES, UINT16_MAX);
+        uint32_t window = ' ';
+        auto shingle = [&](unsigned char c) {
+            window = ((window << 8) | static_cast<uint32_t>(std::tolower(c))) & 0xFFFFFF;
+            uint32_t x = window * 0x85EBCA6Bu;
+            x ^= x >> 15;
+            for (size_t i = 0; i < HASHES; i++) {
+                uint16_t h = static_cast<uint16_t>((x * multipliers[i]) >> 16);
+                signature[i] = std::min(signature[i], h);
+            }
+        };
+        for (char c : name) shingle(static_cast<unsigned char>(c));
+        shingle(' ');
+    }
+
+    static double similarity(const uint16_t* a, const uint16_t* b) {
+        size_t same = 0;
+        for (size_t i = 0; i < HASHES; i++) same += a[i] == b[i];
+        return static_cast<double>(same) / HASHES;
+    }
+
+    // True if every nutrient of `a` and `b` differs by at most `tolerance`
+    // of the larger value (plus one, so zeros compare sensibly)
+    static bool close(const Food& a, const Food& b, double tolerance) {
+        for (auto field : FoodTable::FIELDS) {
+            double x = a.*field;
+            double y = b.*field;
+            if (!(std::fabs(x - y) <= tolerance * (std::max(std::fabs(x), std::fabs(y)) + 1))) return false;
+        }
+        return true;
+    }
+
+    static uint32_t root(std::vector<uint32_t>& parent, uint32_t id) {
+        while (parent[id] != id) {
+            parent[id] = parent[parent[id]];
+            id = parent[id];
+        }
+        return id;
+    }
+
+    // Run `work(i, worker)` for i in [0, count) on up to `threads` threads,
+    // numbered from 0
+    template <typename Fn>
+    static void parallelFor(size_t count, size_t threads, Fn work) {
+        std::atomic<size_t> next{0};
+        auto run = [&](size_t worker) {
+            size_t i;
+            while ((i = next.fetch_add(1)) < count) work(i, worker);
+        };
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < std::min(threads, count); t++) workers.emplace_back(run, t);
+        run(0);
+        for (auto& worker : workers) worker.join();
+    }
+
+public:
+    template <typename Source>
+    Stats build(const Source& source, const Settings& settings = Settings()) {
+        auto start = std::chrono::steady_clock::now();
+        clusters.clear();
+        clusterOf.clear();
+        size_t threads = std::max<size_t>(1, settings.threads);
+        double tolerance = settings.maxDistance;
+
+        // Number the distinct names in visiting order
+        std::vector<const Food*> foods;
+        std::vector<uint32_t> nameOf;
+        std::vector<const std::string*> names;
+        std::unordered_map<std::string_view, uint32_t> nameIds;
+        source.forEach([&](const Food& food) {
+            auto inserted = nameIds.emplace(food.name, static_cast<uint32_t>(names.size()));
+            if (inserted.second) names.push_back(&food.name);
+            foods.push_back(&food);
+            nameOf.push_back(inserted.first->second);
+        });
+
+        // Foods grouped by name, each group sorted by energy
+        std::vector<size_t> nameStart(names.size() + 1, 0);
+        for (uint32_t name : nameOf) nameStart[name + 1]++;
+        for (size_t n = 0; n < names.size(); n++) nameStart[n + 1] += nameStart[n];
+        std::vector<uint32_t> byName(foods.size());
+        {
+            std::vector<size_t> next(nameStart.begin(), nameStart.end() - 1);
+            for (uint32_t id = 0; id < foods.size(); id++) byName[next[nameOf[id]]++] = id;
+        }
+        std::vector<double> energy(foods.size());
+        for (uint32_t id = 0; id < foods.size(); id++) energy[id] = foods[id]->kcal;
+        auto lessEnergy = [&energy](uint32_t a, uint32_t b) {
+            if (energy[a] != energy[b]) return energy[a] < energy[b];
+            return a < b;
+        };
+
+        uint32_t multipliers[HASHES];
+        for (size_t i = 0; i < HASHES; i++) multipliers[i] = multiplier(i);
+        std::vector<uint16_t> signatures(names.size() * HASHES);
+        parallelFor(names.size(), threads, [&](size_t n, size_t) {
+            sign(*names[n], multipliers, &signatures[n * HASHES]);
+            std::sort(byName.begin() + nameStart[n], byName.begin() + nameStart[n + 1], lessEnergy);
+        });
+
+        // Candidate name pairs from each band's buckets. A pair that also
+        // shares an earlier band is left to that band.
+        auto bandKey = [&signatures](uint32_t name, size_t band) {
+            uint64_t key = 0;
+            std::memcpy(&key, &signatures[name * HASHES + band * ROWS], ROWS * sizeof(uint16_t));
+            return key;
+        };
+        std::vector<std::vector<Pair>> bandPairs(BANDS);
+        parallelFor(BANDS, threads, [&](size_t band, size_t) {
+            std::vector<std::pair<uint64_t, uint32_t>> keys(names.size());
+            for (uint32_t n = 0; n < names.size(); n++) keys[n] = {bandKey(n, band), n};
+            std::sort(keys.begin(), keys.end());
+            for (size_t first = 0, last; first < keys.size(); first = last) {
+                for (last = first + 1; last < keys.size() && keys[last].first == keys[first].first; last++) {}
+                for (size_t j = first + 1; j < last; j++) {
+                    for (size_t i = j - std::min(j - first, settings.window); i < j; i++) {
+                        uint32_t a = keys[i].second;
+                        uint32_t b = keys[j].second;
+                        bool seen = false;
+                        for (size_t earlier = 0; earlier < band && !seen; earlier++) {
+                            seen = bandKey(a, earlier) == bandKey(b, earlier);
+                        }
+                        if (!seen && similarity(&signatures[a * HASHES], &signatures[b * HASHES]) >=
+                                         settings.minSimilarity) {
+                            bandPairs[band].push_back({a, b});
+                        }
+                    }
+                }
+            }
+        });
+        // Every name is also paired with itself
+        std::vector<Pair> namePairs;
+        for (uint32_t n = 0; n < names.size(); n++) namePairs.push_back({n, n});
+        for (const auto& pairs : bandPairs) namePairs.insert(namePairs.end(), pairs.begin(), pairs.end());
+
+        // Compare the foods of each name pair: each food of the smaller
+        // group is checked against the foods of the other nearest in energy
+        // on either side (only earlier ones within a single name)
+        std::vector<Found> found(threads);
+        parallelFor(namePairs.size(), threads, [&](size_t p, size_t worker) {
+            Found& out = found[worker];
+            bool same = namePairs[p].a == namePairs[p].b;
+            const uint32_t* a = byName.data() + nameStart[namePairs[p].a];
+            const uint32_t* aEnd = byName.data() + nameStart[namePairs[p].a + 1];
+            const uint32_t* b = byName.data() + nameStart[namePairs[p].b];
+            const uint32_t* bEnd = byName.data() + nameStart[namePairs[p].b + 1];
+            if (bEnd - b > aEnd - a) {
+                std::swap(a, b);
+                std::swap(aEnd, bEnd);
+            }
+            size_t side = same ? settings.window : (settings.window + 1) / 2;
+            const uint32_t* middle = a; // first food of `a` not below the current energy
+            for (const uint32_t* food = b; food != bEnd; ++food) {
+                const Food& current = *foods[*food];
+                auto check = [&](const uint32_t* other) {
+                    out.compared++;
+                    if (close(current, *foods[*other], tolerance)) out.pairs.push_back({*food, *other});
+                };
+                if (same) {
+                    middle = food;
+                } else {
+                    middle = std::lower_bound(middle, aEnd, current.kcal,
+                                              [&energy](uint32_t id, double kcal) { return energy[id] < kcal; });
+                }
+                const uint32_t* other = middle;
+                for (size_t n = 0; n < side && other != a; n++) {
+                    --other;
+                    if (current.kcal - energy[*other] > tolerance * (current.kcal + 1)) break;
+                    check(other);
+                }
+                if (same) continue;
+                other = middle;
+                for (size_t n = 0; n < side && other != aEnd; n++, ++other) {
+                    double kcal = energy[*other];
+                    if (kcal - current.kcal > tolerance * (kcal + 1)) break;
+                    check(other);
+                }
+            }
+        });
+
+        std::vector<uint32_t> parent(foods.size());
+        for (uint32_t id = 0; id < foods.size(); id++) parent[id] = id;
+        Stats stats;
+        stats.foods = foods.size();
+        stats.names = names.size();
+        stats.namePairs = namePairs.size() - names.size();
+        for (const Found& part : found) {
+            stats.compared += part.compared;
+            for (const Pair& pair : part.pairs) {
+                uint32_t a = root(parent, pair.a);
+                uint32_t b = root(parent, pair.b);
+                if (a != b) parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+
+        // Number the clusters in order of their first food
+        std::vector<uint32_t> clusterOfRoot(foods.size(), UINT32_MAX);
+        std::vector<size_t> sizes(foods.size(), 0);
+        for (uint32_t id = 0; id < foods.size(); id++) sizes[root(parent, id)]++;
+        for (uint32_t id = 0; id < foods.size(); id++) {
+            uint32_t top = root(parent, id);
+            if (sizes[top] < 2) continue;
+            if (clusterOfRoot[top] == UINT32_MAX) {
+                clusterOfRoot[top] = static_cast<uint32_t>(clusters.size());
+                clusters.push_back({foods[id], sizes[top]});
+            }
+            uint32_t cluster = clusterOfRoot[top];
+            clusterOf.emplace(foods[id], cluster);
+            const Food*& representative = clusters[cluster].representative;
+            if (foods[id]->name.size() < representative->name.size()) representative = foods[id];
+            stats.duplicates++;
+        }
+        stats.clusters = clusters.size();
+        stats.duplicates -= clusters.size();
+        for (const Cluster& cluster : clusters) stats.largest = std::max(stats.largest, cluster.size);
+        stats.millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - start).count();
+        lastStats = stats;
+        return stats;
+    }
+
+    const Stats& stats() const { return lastStats; }
+
+    // The food standing in for `food`'s cluster (`food` itself if it has
+    // no near-duplicates)
+    const Food* representative(const Food* food) const {
+        auto it = clusterOf.find(food);
+        return it == clusterOf.end() ? food : clusters[it->second].representative;
+    }
+
+    size_t clusterSize(const Food* food) const {
+        auto it = clusterOf.find(food);
+        return it == clusterOf.end() ? 1 : clusters[it->second].size;
+    }
+
+    // Keep one entry per cluster, in order: each cluster's representative,
+    // where its first member was. Returns how many were dropped.
+    size_t collapse(std::vector<const Food*>& results) const {
+        if (clusters.empty()) return 0;
+        std::unordered_set<uint32_t> seen;
+        size_t kept = 0;
+        for (const Food* food : results) {
+            auto it = clusterOf.find(food);
+            if (it == clusterOf.end()) {
+                results[kept++] = food;
+            } else if (seen.insert(it->second).second) {
+                results[kept++] = clusters[it->second].representative;
+            }
+        }
+        size_t dropped = results.size() - kept;
+        results.resize(kept);
+        return dropped;
+    }
+
+    // Up to `n` of the largest clusters, largest first
+    void largestClusters(size_t n, std::vector<Cluster>& out) const {
+        size_t first = out.size();
+        out.insert(out.end(), clusters.begin(), clusters.end());
+        auto bigger = [](const Cluster& a, const Cluster& b) { return a.size > b.size; };
+        std::stable_sort(out.begin() + first, out.end(), bigger);
+        if (out.size() - first > n) out.resize(first + n);
+    }
+};
+
+#endif // DUPLICATE_INDEX_H
@@ -0,0 +1,63 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#if defined(__linux__)
+
+#include <string>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Reports when one file is rewritten or replaced. The watch is on the
+// parent directory, so files swapped in with rename() are seen as well as
+// ones written in place.
+class FileWatcher {
+    int fd = -1;
+    std::string name;
+
+public:
+    explicit FileWatcher(const std::string& path) {
+        size_t slash = path.find_last_of('/');
+        std::string dir = slash == std::string::npos ? "." : path.substr(0, slash);
+        if (dir.empty()) dir = "/";
+        name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd >= 0 && inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    ~FileWatcher() {
+        if (fd >= 0) close(fd);
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool ok() const { return fd >= 0; }
+
+    // Wait up to timeoutMs; true if the watched file changed meanwhile
+    bool waitForChange(int timeoutMs) {
+        pollfd entry{fd, POLLIN, 0};
+        if (fd < 0 || poll(&entry, 1, timeoutMs) <= 0) return false;
+
+        bool changed = false;
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                if (event->len > 0 && name == event->name) changed = true;
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        return changed;
+    }
+};
+
+#endif // __linux__
+
+#endif // FILE_WATCHER_H
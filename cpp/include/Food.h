@@ -5,6 +5,7 @@
 
 #include <string>
 #include <sstream>
+#include <utility>
 
 struct Food {
     std::string name;
@@ -22,8 +23,41 @@ struct Food {
 
     Food(std::string n, double k, double p, double f, double c, 
          double sg, double fb, double sf, double sd)
-        : name(n), kcal(k), protein(p), fat(f), carbs(c), 
+        : name(std::move(n)), kcal(k), protein(p), fat(f), carbs(c), 
           sugar(sg), fiber(fb), satfat(sf), sodium(sd) {}
+    // Copy with every nutrient scaled from per-100g to the given serving
+    Food scaledTo(double grams) const {
+        double multiplier = grams / 100.0;
+        return Food(name, kcal * multiplier, protein * multiplier, fat * multiplier,
+                    carbs * multiplier, sugar * multiplier, fiber * multiplier,
+                    satfat * multiplier, sodium * multiplier);
+    }
+
+    // Add another food's nutrients onto this one (name is left unchanged)
+    void accumulate(const Food& other) {
+        kcal += other.kcal;
+        protein += other.protein;
+        fat += other.fat;
+        carbs += other.carbs;
+        sugar += other.sugar;
+        fiber += other.fiber;
+        satfat += other.satfat;
+        sodium += other.sodium;
+    }
+
+    // Add `grams` of another food (given per 100g) without copying it
+    void accumulate(const Food& other, double grams) {
+        double multiplier = grams / 100.0;
+        kcal += other.kcal * multiplier;
+        protein += other.protein * multiplier;
+        fat += other.fat * multiplier;
+        carbs += other.carbs * multiplier;
+        sugar += other.sugar * multiplier;
+        fiber += other.fiber * multiplier;
+        satfat += other.satfat * multiplier;
+        sodium += other.sodium * multiplier;
+    }
+
     // Convert kcal to kJ (1 kcal = 4.184 kJ)
     double getEnergyKJ() const {
         return kcal * 4.184;
@@ -42,87 +76,32 @@ struct Food {
         return score;
     }
 
-    // Calculate negative points (energy, sat fat, sugars, sodium)
-    int calculateNegativePoints() const {
+    // Upper bound of each points band: a value earns one point for every
+    // bound it exceeds, so 0-335 kJ scores 0 and anything over 3350 kJ 10
+    static constexpr double ENERGY_KJ_BANDS[10] = {335, 670, 1005, 1340, 1675, 2010, 2345, 2680, 3015, 3350};
+    static constexpr double SATFAT_BANDS[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    static constexpr double SUGAR_BANDS[10] = {4.5, 9, 13.5, 18, 22.5, 27, 31, 36, 40, 45};
+    static constexpr double SODIUM_BANDS[10] = {90, 180, 270, 360, 450, 540, 630, 720, 810, 900};
+    static constexpr double PROTEIN_BANDS[5] = {1.6, 3.2, 4.8, 6.4, 8.0};
+    static constexpr double FIBER_BANDS[5] = {0.9, 1.9, 2.8, 3.7, 4.7};
+
+    // Bands exceeded by `value`, counted without branches (NaN exceeds all)
+    template <size_t N>
+    static int bandPoints(double value, const double (&bands)[N]) {
         int points = 0;
-        double energyKJ = getEnergyKJ();
-        
-        // Energy points
-        if (energyKJ <= 335) points += 0;
-        else if (energyKJ <= 670) points += 1;
-        else if (energyKJ <= 1005) points += 2;
-        else if (energyKJ <= 1340) points += 3;
-        else if (energyKJ <= 1675) points += 4;
-        else if (energyKJ <= 2010) points += 5;
-        else if (energyKJ <= 2345) points += 6;
-        else if (energyKJ <= 2680) points += 7;
-        else if (energyKJ <= 3015) points += 8;
-        else if (energyKJ <= 3350) points += 9;
-        else points += 10;
-        
-        // Saturated fat points
-        if (satfat <= 1) points += 0;
-        else if (satfat <= 2) points += 1;
-        else if (satfat <= 3) points += 2;
-        else if (satfat <= 4) points += 3;
-        else if (satfat <= 5) points += 4;
-        else if (satfat <= 6) points += 5;
-        else if (satfat <= 7) points += 6;
-        else if (satfat <= 8) points += 7;
-        else if (satfat <= 9) points += 8;
-        else if (satfat <= 10) points += 9;
-        else points += 10;
-        
-        // Sugar points
-        if (sugar <= 4.5) points += 0;
-        else if (sugar <= 9) points += 1;
-        else if (sugar <= 13.5) points += 2;
-        else if (sugar <= 18) points += 3;
-        else if (sugar <= 22.5) points += 4;
-        else if (sugar <= 27) points += 5;
-        else if (sugar <= 31) points += 6;
-        else if (sugar <= 36) points += 7;
-        else if (sugar <= 40) points += 8;
-        else if (sugar <= 45) points += 9;
-        else points += 10;
-        
-        // Sodium points
-        if (sodium <= 90) points += 0;
-        else if (sodium <= 180) points += 1;
-        else if (sodium <= 270) points += 2;
-        else if (sodium <= 360) points += 3;
-        else if (sodium <= 450) points += 4;
-        else if (sodium <= 540) points += 5;
-        else if (sodium <= 630) points += 6;
-        else if (sodium <= 720) points += 7;
-        else if (sodium <= 810) points += 8;
-        else if (sodium <= 900) points += 9;
-        else points += 10;
-        
+        for (double bound : bands) points += !(value <= bound);
         return points;
     }
 
+    // Calculate negative points (energy, sat fat, sugars, sodium)
+    int calculateNegativePoints() const {
+        return bandPoints(getEnergyKJ(), ENERGY_KJ_BANDS) + bandPoints(satfat, SATFAT_BANDS) +
+               bandPoints(sugar, SUGAR_BANDS) + bandPoints(sodium, SODIUM_BANDS);
+    }
+
     // Calculate positive points (protein, fiber)
     int calculatePositivePoints() const {
-        int points = 0;
-        
-        // Protein points
-        if (protein <= 1.6) points += 0;
-        else if (protein <= 3.2) points += 1;
-        else if (protein <= 4.8) points += 2;
-        else if (protein <= 6.4) points += 3;
-        else if (protein <= 8.0) points += 4;
-        else points += 5;
-        
-        // Fiber points
-        if (fiber <= 0.9) points += 0;
-        else if (fiber <= 1.9) points += 1;
-        else if (fiber <= 2.8) points += 2;
-        else if (fiber <= 3.7) points += 3;
-        else if (fiber <= 4.7) points += 4;
-        else points += 5;
-        
-        return points;
+        return bandPoints(protein, PROTEIN_BANDS) + bandPoints(fiber, FIBER_BANDS);
     }
 
     // Get feedback based on score
@@ -0,0 +1,124 @@
+#ifndef FOOD_TABLE_H
+#define FOOD_TABLE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include "Food.h"
+
+using FoodId = uint32_t;
+
+// Every distinct food (name plus per-100g nutrients) stored once under a
+// small integer id, so meals can refer to foods without copying them.
+// Ids are dense and handed out in insertion order. Nutrients are kept one
+// column per field, so totals touch only the numbers.
+//
+// An id only means something within its own table: the current meal's
+// table (emptied with the meal) or the one read back from the history log.
+// It is not a dataset-wide id; the search indexes number foods their own
+// way, and a meal's foods are matched against the dataset by name.
+class FoodTable {
+public:
+    // The nutrient columns, in Food field order
+    static const int FIELD_COUNT = 8;
+    static constexpr double Food::*FIELDS[FIELD_COUNT] = {
+        &Food::kcal, &Food::protein, &Food::fat, &Food::carbs,
+        &Food::sugar, &Food::fiber, &Food::satfat, &Food::sodium};
+
+private:
+    std::vector<std::string> names;
+    std::vector<double> columns[FIELD_COUNT];
+    std::unordered_multimap<size_t, FoodId> ids; // hash of the food -> id
+
+    // Hash of the name and the raw nutrient bytes: two rows with the same
+    // name but different values are different foods
+    static size_t hashOf(const Food& food) {
+        size_t hash = std::hash<std::string>()(food.name);
+        for (auto field : FIELDS) {
+            uint64_t bits;
+            std::memcpy(&bits, &(food.*field), sizeof(bits));
+            hash ^= std::hash<uint64_t>()(bits) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    bool matches(FoodId id, const Food& food) const {
+        if (names[id] != food.name) return false;
+        for (int i = 0; i < FIELD_COUNT; i++) {
+            if (std::memcmp(&columns[i][id], &(food.*FIELDS[i]), sizeof(double)) != 0) return false;
+        }
+        return true;
+    }
+
+    // Id of `food` among the ids stored under `hash`, or size()
+    FoodId lookup(const Food& food, size_t hash) const {
+        auto range = ids.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (matches(it->second, food)) return it->second;
+        }
+        return static_cast<FoodId>(names.size());
+    }
+
+    void push(const Food& food) {
+        names.push_back(food.name);
+        for (int i = 0; i < FIELD_COUNT; i++) columns[i].push_back(food.*FIELDS[i]);
+    }
+
+public:
+    // Id of `food`, adding it if it is new
+    FoodId intern(const Food& food) {
+        size_t hash = hashOf(food);
+        FoodId id = lookup(food, hash);
+        if (id == names.size()) {
+            ids.emplace(hash, id);
+            push(food);
+        }
+        return id;
+    }
+
+    // Id of `food` if it is already in the table, otherwise size() (the id
+    // intern() would give it)
+    FoodId find(const Food& food) const { return lookup(food, hashOf(food)); }
+
+    // Add `food` under the next id without checking for an existing copy
+    // (used when reading back a table that was written deduplicated)
+    FoodId add(const Food& food) {
+        FoodId id = static_cast<FoodId>(names.size());
+        ids.emplace(hashOf(food), id);
+        push(food);
+        return id;
+    }
+
+    // The food with this id, put back together from the columns
+    Food get(FoodId id) const {
+        Food food;
+        food.name = names[id];
+        for (int i = 0; i < FIELD_COUNT; i++) food.*FIELDS[i] = columns[i][id];
+        return food;
+    }
+
+    const std::string& name(FoodId id) const { return names[id]; }
+
+    // Per-100g value of nutrient `field` (an index into FIELDS)
+    double value(FoodId id, int field) const { return columns[field][id]; }
+
+    // Add `grams` of food `id` onto `total`
+    void accumulate(Food& total, FoodId id, double grams) const {
+        double multiplier = grams / 100.0;
+        for (int i = 0; i < FIELD_COUNT; i++) total.*FIELDS[i] += columns[i][id] * multiplier;
+    }
+
+    bool contains(FoodId id) const { return id < names.size(); }
+    size_t size() const { return names.size(); }
+
+    void clear() {
+        names.clear();
+        for (auto& column : columns) column.clear();
+        ids.clear();
+    }
+};
+
+#endif // FOOD_TABLE_H
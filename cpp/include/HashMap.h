@@ -3,15 +3,56 @@
 
 #include <string>
 #include <vector>
-#include <list>
 #include <algorithm>
 #include <cctype>
+#include <functional>
 #include "Food.h"
 #include <iostream>
+#include <numeric>
+#include <thread>
+#include "Arena.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HASHMAP_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HASHMAP_PREFETCH(addr) ((void)0)
+#endif
 
 class HashMap {
     static const int TABLE_SIZE = 100000;
-    std::vector<std::list<Food>> table;
+
+    // Chain links live in the arena and point at records in the pool, so a
+    // build allocates in large blocks and teardown frees blocks, not nodes
+    struct Entry {
+        const Food* food;
+        Entry* next;
+    };
+    struct Bucket {
+        Entry* head = nullptr;
+        Entry* tail = nullptr; // appended at the tail to keep insertion order
+    };
+
+    // Links and records for one builder thread; insert() uses the first
+    struct Storage {
+        Arena entries;
+        RecordPool<Food> records;
+    };
+
+    std::vector<Bucket> table;
+    std::vector<Storage> storage;
+
+    // With `copy` the food is stored in the pool, otherwise it is referenced
+    void append(int index, const Food& food, Storage& into, bool copy) {
+        const Food* record = copy ? into.records.add(food) : &food;
+        Entry* entry = into.entries.create<Entry>(Entry{record, nullptr});
+        Bucket& bucket = table[index];
+        if (bucket.tail != nullptr) {
+            bucket.tail->next = entry;
+        } else {
+            bucket.head = entry;
+        }
+        bucket.tail = entry;
+    }
 
     // Hash function for strings
     int hashFunction(const std::string& key) const {
@@ -29,56 +70,282 @@ class HashMap {
         return result;
     }
 
+    // Compare against an already lowercased key without allocating
+    static bool equalsLower(const std::string& name, const std::string& lowerKey) {
+        if (name.size() != lowerKey.size()) return false;
+        for (size_t i = 0; i < name.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(name[i])) != lowerKey[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Case-insensitive substring test against an already lowercased term
+    static bool containsLower(const std::string& name, const std::string& lowerTerm) {
+        auto it = std::search(name.begin(), name.end(), lowerTerm.begin(), lowerTerm.end(),
+                              [](char a, char b) {
+                                  return std::tolower(static_cast<unsigned char>(a)) == b;
+                              });
+        return it != name.end() || lowerTerm.empty();
+    }
+
+    static bool startsWithLower(const std::string& name, const std::string& lowerPrefix) {
+        if (name.size() < lowerPrefix.size()) return false;
+        for (size_t i = 0; i < lowerPrefix.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(name[i])) != lowerPrefix[i]) return false;
+        }
+        return true;
+    }
+
+    static std::vector<Food> copyOut(const std::vector<const Food*>& refs) {
+        std::vector<Food> results;
+        results.reserve(refs.size());
+        for (const Food* food : refs) results.push_back(*food);
+        return results;
+    }
+
+    // Drop `e` (whose predecessor is `prev`) from the chain; `e->next` is
+    // left intact so a loop over the chain can continue past it
+    static void unlink(Bucket& bucket, Entry* prev, Entry* e) {
+        if (prev != nullptr) {
+            prev->next = e->next;
+        } else {
+            bucket.head = e->next;
+        }
+        if (bucket.tail == e) bucket.tail = prev;
+    }
+
+    // How many distinct queries ahead of the current one to prefetch
+    static const size_t PREFETCH_DISTANCE = 8;
+
 public:
-    HashMap() : table(TABLE_SIZE) {}
+    HashMap() : table(TABLE_SIZE), storage(1) {}
     // Insert food item
     void insert(const Food& food) {
+        append(hashFunction(food.name), food, storage[0], true);
+    }
+
+    // Bulk insert on several threads. Every food is hashed once, then the
+    // table is split into contiguous bucket ranges (the high part of the
+    // bucket index) and each thread fills only its own range, with its own
+    // arena and record pool, so no bucket is shared. Buckets end up in the
+    // same order as inserting one at a time.
+    void insertAll(const std::vector<Food>& foods, size_t threads = std::thread::hardware_concurrency()) {
+        insertAll(foods.data(), foods.size(), threads);
+    }
+
+    // Same for foods[0..count); calling it on consecutive slices gives the
+    // same result as one call, and the per-thread storage is reused
+    void insertAll(const Food* foods, size_t count, size_t threads) {
+        bulkInsert(foods, count, threads, true);
+    }
+
+    // Like insertAll, but the index points at the caller's records instead
+    // of copying them. They must not move and must outlive the HashMap.
+    void indexAll(const Food* foods, size_t count, size_t threads) {
+        bulkInsert(foods, count, threads, false);
+    }
+
+private:
+    void bulkInsert(const Food* foods, size_t count, size_t threads, bool copy) {
+        if (threads == 0) threads = 1;
+        threads = std::min(threads, std::max<size_t>(1, count / 1024));
+        if (threads == 1) {
+            for (size_t i = 0; i < count; i++) {
+                append(hashFunction(foods[i].name), foods[i], storage[0], copy);
+            }
+            return;
+        }
+
+        std::vector<int> buckets(count);
+        if (storage.size() < threads + 1) storage.resize(threads + 1);
+        auto forEachThread = [threads](const std::function<void(size_t)>& work) {
+            std::vector<std::thread> workers;
+            for (size_t t = 1; t < threads; t++) workers.emplace_back(work, t);
+            work(0);
+            for (auto& worker : workers) worker.join();
+        };
+
+        forEachThread([&](size_t t) {
+            size_t begin = count * t / threads;
+            size_t end = count * (t + 1) / threads;
+            for (size_t i = begin; i < end; i++) buckets[i] = hashFunction(foods[i].name);
+        });
+        forEachThread([&](size_t t) {
+            int low = static_cast<int>(TABLE_SIZE * t / threads);
+            int high = static_cast<int>(TABLE_SIZE * (t + 1) / threads);
+            Storage& into = storage[1 + t];
+            for (size_t i = 0; i < count; i++) {
+                if (buckets[i] >= low && buckets[i] < high) append(buckets[i], foods[i], into, copy);
+            }
+        });
+    }
+
+public:
+    // Replace every food with this name (matched like searchExact) by one
+    // copy of `food`, or add it if there is none. Returns how many foods
+    // had the name (0 if it was added), so callers can tell when several
+    // rows collapsed into one. Superseded records and unlinked entries stay
+    // in the arena and pool until the map is destroyed.
+    size_t upsert(const Food& food) {
         int index = hashFunction(food.name);
-        table[index].push_back(food);
+        std::string key = toLower(food.name);
+        const Food* record = storage[0].records.add(food);
+        Bucket& bucket = table[index];
+
+        size_t matched = 0;
+        Entry* prev = nullptr;
+        for (Entry* e = bucket.head; e != nullptr; e = e->next) {
+            if (!equalsLower(e->food->name, key)) {
+                prev = e;
+            } else if (matched++ == 0) {
+                e->food = record;
+                prev = e;
+            } else {
+                unlink(bucket, prev, e);
+            }
+        }
+        if (matched == 0) append(index, *record, storage[0], false);
+        return matched;
+    }
+
+    // Remove every food with this name; returns how many were removed
+    size_t remove(const std::string& name) {
+        std::string key = toLower(name);
+        Bucket& bucket = table[hashFunction(name)];
+        size_t removed = 0;
+        Entry* prev = nullptr;
+        for (Entry* e = bucket.head; e != nullptr; e = e->next) {
+            if (equalsLower(e->food->name, key)) {
+                unlink(bucket, prev, e);
+                removed++;
+            } else {
+                prev = e;
+            }
+        }
+        return removed;
     }
+
     //exact match
     std::vector<Food> searchExact(const std::string& name) const {
-        std::vector<Food> results;
+        std::vector<const Food*> refs;
+        searchExact(name, refs);
+        return copyOut(refs);
+    }
+
+    // The search overloads taking an output vector append pointers to the
+    // stored foods instead of copying them, so callers can reuse the buffer
+    void searchExact(const std::string& name, std::vector<const Food*>& out) const {
         int index = hashFunction(name);
         std::string lowerName = toLower(name);
 
-        for (const auto& food : table[index]) {
-            if (toLower(food.name) == lowerName) {
-                results.push_back(food);
+        for (const Entry* e = table[index].head; e != nullptr; e = e->next) {
+            if (equalsLower(e->food->name, lowerName)) {
+                out.push_back(e->food);
+            }
+        }
+    }
+
+    // Exact match for many names at once. Queries are sorted and deduplicated
+    // so each distinct name is hashed and looked up once, and buckets a few
+    // queries ahead are prefetched while the current chain is compared.
+    // Results come back in the same order as the input.
+    std::vector<std::vector<Food>> searchExactBatch(const std::vector<std::string>& names) const {
+        std::vector<std::vector<Food>> results(names.size());
+        if (names.empty()) return results;
+
+        std::vector<std::string> keys(names.size());
+        for (size_t i = 0; i < names.size(); i++) {
+            keys[i] = toLower(names[i]);
+        }
+        std::vector<size_t> order(names.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+        // First input position of every distinct key, plus its bucket
+        std::vector<size_t> distinct;
+        distinct.reserve(order.size());
+        for (size_t i : order) {
+            if (distinct.empty() || keys[distinct.back()] != keys[i]) {
+                distinct.push_back(i);
+            }
+        }
+        std::vector<int> buckets(distinct.size());
+        for (size_t d = 0; d < distinct.size(); d++) {
+            buckets[d] = hashFunction(keys[distinct[d]]);
+        }
+
+        std::vector<size_t> owner(names.size());
+        for (size_t d = 0, i = 0; d < distinct.size(); d++) {
+            if (d + PREFETCH_DISTANCE < distinct.size()) {
+                const Bucket& ahead = table[buckets[d + PREFETCH_DISTANCE]];
+                HASHMAP_PREFETCH(&ahead);
+                if (ahead.head != nullptr) HASHMAP_PREFETCH(ahead.head);
+            }
+
+            const std::string& key = keys[distinct[d]];
+            std::vector<Food>& found = results[distinct[d]];
+            for (const Entry* e = table[buckets[d]].head; e != nullptr; e = e->next) {
+                if (equalsLower(e->food->name, key)) {
+                    found.push_back(*e->food);
+                }
             }
+            // Every duplicate of this key shares the first position's results
+            for (; i < order.size() && keys[order[i]] == key; i++) {
+                owner[order[i]] = distinct[d];
+            }
+        }
+        for (size_t i = 0; i < names.size(); i++) {
+            if (owner[i] != i) results[i] = results[owner[i]];
         }
         return results;
     }
     // Search for prefix matches
     std::vector<Food> searchPrefix(const std::string& prefix) const {
-        std::vector<Food> results;
+        std::vector<const Food*> refs;
+        searchPrefix(prefix, refs);
+        return copyOut(refs);
+    }
+
+    void searchPrefix(const std::string& prefix, std::vector<const Food*>& out) const {
         std::string lowerPrefix = toLower(prefix);
 
         for (const auto& bucket : table) {
-            for (const auto& food : bucket) {
-                std::string lowerName = toLower(food.name);
-                if (lowerName.find(lowerPrefix) == 0) { // Check if starts with prefix
-                    results.push_back(food);
+            for (const Entry* e = bucket.head; e != nullptr; e = e->next) {
+                if (startsWithLower(e->food->name, lowerPrefix)) {
+                    out.push_back(e->food);
                 }
             }
         }
-        return results;
     }
 
     // Search for foods containing the search term anywhere in the name
     std::vector<Food> searchContains(const std::string& searchTerm) const {
-        std::vector<Food> results;
+        std::vector<const Food*> refs;
+        searchContains(searchTerm, refs);
+        return copyOut(refs);
+    }
+
+    void searchContains(const std::string& searchTerm, std::vector<const Food*>& out) const {
         std::string lowerTerm = toLower(searchTerm);
 
         for (const auto& bucket : table) {
-            for (const auto& food : bucket) {
-                std::string lowerName = toLower(food.name);
-                if (lowerName.find(lowerTerm) != std::string::npos) {
-                    results.push_back(food);
+            for (const Entry* e = bucket.head; e != nullptr; e = e->next) {
+                if (containsLower(e->food->name, lowerTerm)) {
+                    out.push_back(e->food);
                 }
             }
         }
-        return results;
+    }
+
+    // Visit every indexed food, bucket by bucket
+    template <typename Fn>
+    void forEach(Fn visit) const {
+        for (const auto& bucket : table) {
+            for (const Entry* e = bucket.head; e != nullptr; e = e->next) visit(*e->food);
+        }
     }
 
     // Get statistics about the hash table
@@ -88,9 +355,10 @@ public:
         int totalItems = 0;
 
         for (const auto& bucket : table) {
-            if (!bucket.empty()) {
+            if (bucket.head != nullptr) {
                 nonEmptyBuckets++;
-                int chainLength = bucket.size();
+                int chainLength = 0;
+                for (const Entry* e = bucket.head; e != nullptr; e = e->next) chainLength++;
                 totalItems += chainLength;
                 if (chainLength > maxChainLength) {
                     maxChainLength = chainLength;
@@ -104,6 +372,15 @@ public:
         std::cout << "Non-empty Buckets: " << nonEmptyBuckets << std::endl;
         std::cout << "Load Factor: " << (double)totalItems / TABLE_SIZE << std::endl;
         std::cout << "Max Chain Length: " << maxChainLength << std::endl;
+        size_t arenaBytes = 0, arenaBlocks = 0, recordBytes = 0;
+        for (const auto& part : storage) {
+            arenaBytes += part.entries.bytesUsed();
+            arenaBlocks += part.entries.blockCount();
+            recordBytes += part.records.bytesReserved();
+        }
+        std::cout << "Arena: " << arenaBytes / 1024 << " KiB in "
+                  << arenaBlocks << " block(s), records "
+                  << recordBytes / 1024 << " KiB" << std::endl;
     }
 };
 
@@ -0,0 +1,538 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+// Minimal HTTP/1.1 server on epoll (Linux only). Handles keep-alive and
+// pipelined GET/POST requests, dispatches registered paths to handlers and
+// serves everything else as static files from a directory. One thread owns
+// every socket; given a ThreadPool, handlers run on the workers and finished
+// responses are handed back to the event loop through an eventfd.
+
+#include <string>
+#include <map>
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::map<std::string, std::string> params; // decoded query string
+    std::string body;
+    bool keepAlive = true;
+
+    std::string param(const std::string& key, const std::string& fallback = "") const {
+        auto it = params.find(key);
+        return it == params.end() ? fallback : it->second;
+    }
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    std::string body;
+};
+
+#if defined(__linux__)
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include "ThreadPool.h"
+
+class HttpServer {
+public:
+    using Handler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+private:
+    static const size_t MAX_HEADER_BYTES = 16 * 1024;
+    static const size_t MAX_BODY_BYTES = 1024 * 1024;
+    static const int MAX_EVENTS = 256;
+
+    struct Connection {
+        std::string in;
+        std::string out;
+        size_t outOffset = 0;
+        bool closeAfterWrite = false;
+        uint32_t events = EPOLLIN | EPOLLRDHUP; // as registered with epoll
+        bool busy = false;      // a request is being handled on the pool
+        uint64_t id = 0;        // distinguishes reuses of the same fd
+    };
+
+    // A response produced on a worker, waiting for the event loop
+    struct Completion {
+        int fd;
+        uint64_t id;
+        std::string bytes;
+        bool keepAlive;
+    };
+
+    std::string staticRoot;
+    ThreadPool* pool;
+    int wakeFd = -1;
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+    std::atomic<size_t> inFlight{0};
+    uint64_t nextConnectionId = 1;
+    std::unordered_map<std::string, Handler> routes;
+    std::unordered_map<int, Connection> connections;
+    int listenFd = -1;
+    int epollFd = -1;
+
+    static bool setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static const char* statusText(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 400: return "Bad Request";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 413: return "Payload Too Large";
+            case 431: return "Request Header Fields Too Large";
+            default: return "Internal Server Error";
+        }
+    }
+
+    static std::string contentTypeFor(const std::string& path) {
+        size_t dot = path.rfind('.');
+        std::string ext = dot == std::string::npos ? "" : path.substr(dot + 1);
+        if (ext == "html") return "text/html; charset=utf-8";
+        if (ext == "css") return "text/css; charset=utf-8";
+        if (ext == "js") return "application/javascript; charset=utf-8";
+        if (ext == "json") return "application/json";
+        if (ext == "csv") return "text/csv; charset=utf-8";
+        if (ext == "svg") return "image/svg+xml";
+        if (ext == "png") return "image/png";
+        if (ext == "ico") return "image/x-icon";
+        return "application/octet-stream";
+    }
+
+    static std::string headerValue(const std::string& head, const std::string& lowerName) {
+        size_t pos = 0;
+        while ((pos = head.find("\r\n", pos)) != std::string::npos) {
+            pos += 2;
+            size_t colon = head.find(':', pos);
+            size_t eol = head.find("\r\n", pos);
+            if (colon == std::string::npos || (eol != std::string::npos && colon > eol)) continue;
+            std::string name = head.substr(pos, colon - pos);
+            for (auto& c : name) c = std::tolower(static_cast<unsigned char>(c));
+            if (name == lowerName) {
+                size_t start = head.find_first_not_of(' ', colon + 1);
+                size_t end = eol == std::string::npos ? head.size() : eol;
+                return start < end ? head.substr(start, end - start) : "";
+            }
+        }
+        return "";
+    }
+
+    void serveStatic(const HttpRequest& request, HttpResponse& response) const {
+        std::string path = request.path == "/" ? "/index.html" : request.path;
+        if (path.find("..") != std::string::npos) {
+            response.status = 403;
+            response.body = "{\"error\":\"forbidden\"}";
+            return;
+        }
+        std::ifstream file(staticRoot + path, std::ios::binary);
+        if (!file.is_open()) {
+            response.status = 404;
+            response.body = "{\"error\":\"not found\"}";
+            return;
+        }
+        std::ostringstream content;
+        content << file.rdbuf();
+        response.contentType = contentTypeFor(path);
+        response.body = content.str();
+    }
+
+    // A HEAD response carries the headers of the GET, Content-Length
+    // included, without the body
+    static void appendResponse(std::string& out, const HttpResponse& response, bool keepAlive,
+                               bool head = false) {
+        out += "HTTP/1.1 ";
+        out += std::to_string(response.status);
+        out += ' ';
+        out += statusText(response.status);
+        out += "\r\nContent-Type: ";
+        out += response.contentType;
+        out += "\r\nContent-Length: ";
+        out += std::to_string(response.body.size());
+        out += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+        if (!head) out += response.body;
+    }
+
+    void respond(Connection& conn, const HttpResponse& response, bool keepAlive, bool head = false) {
+        appendResponse(conn.out, response, keepAlive, head);
+        if (!keepAlive) conn.closeAfterWrite = true;
+    }
+
+    // Run the request on a worker; the response comes back via drainCompletions
+    void handOff(int fd, Connection& conn, HttpRequest request) {
+        conn.busy = true;
+        inFlight.fetch_add(1);
+        uint64_t id = conn.id;
+        auto shared = std::make_shared<HttpRequest>(std::move(request));
+        pool->submit([this, fd, id, shared] {
+            HttpResponse response;
+            dispatch(*shared, response);
+            Completion done{fd, id, std::string(), shared->keepAlive};
+            appendResponse(done.bytes, response, shared->keepAlive, shared->method == "HEAD");
+            {
+                std::lock_guard<std::mutex> lock(completionMutex);
+                completions.push_back(std::move(done));
+            }
+            uint64_t one = 1;
+            ssize_t ignored = write(wakeFd, &one, sizeof(one));
+            (void)ignored;
+            inFlight.fetch_sub(1);
+        });
+    }
+
+    void drainCompletions() {
+        uint64_t count;
+        ssize_t ignored = read(wakeFd, &count, sizeof(count));
+        (void)ignored;
+
+        std::vector<Completion> ready;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            ready.swap(completions);
+        }
+        for (auto& done : ready) {
+            auto it = connections.find(done.fd);
+            if (it == connections.end() || it->second.id != done.id) continue; // closed meanwhile
+            Connection& conn = it->second;
+            conn.busy = false;
+            conn.out += done.bytes;
+            if (!done.keepAlive) conn.closeAfterWrite = true;
+            processInput(done.fd, conn);
+            flushOutput(done.fd, conn);
+        }
+    }
+
+    void dispatch(const HttpRequest& request, HttpResponse& response) const {
+        if (request.method != "GET" && request.method != "POST" && request.method != "HEAD") {
+            response.status = 405;
+            response.body = "{\"error\":\"method not allowed\"}";
+            return;
+        }
+        auto route = routes.find(request.path);
+        if (route != routes.end()) {
+            route->second(request, response);
+        } else {
+            serveStatic(request, response);
+        }
+    }
+
+    // Parse and answer every complete request buffered on the connection.
+    // Returns false on a malformed request (the connection is then closed
+    // after the error response is written).
+    bool processInput(int fd, Connection& conn) {
+        while (!conn.closeAfterWrite && !conn.busy) {
+            size_t headerEnd = conn.in.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) {
+                if (conn.in.size() > MAX_HEADER_BYTES) {
+                    HttpResponse error;
+                    error.status = 431;
+                    error.body = "{\"error\":\"headers too large\"}";
+                    respond(conn, error, false);
+                    return false;
+                }
+                return true;
+            }
+
+            std::string head = conn.in.substr(0, headerEnd);
+            size_t contentLength = std::strtoul(headerValue(head, "content-length").c_str(), nullptr, 10);
+            if (contentLength > MAX_BODY_BYTES) {
+                HttpResponse error;
+                error.status = 413;
+                error.body = "{\"error\":\"body too large\"}";
+                respond(conn, error, false);
+                return false;
+            }
+            if (conn.in.size() < headerEnd + 4 + contentLength) return true;
+
+            HttpRequest request;
+            request.body = conn.in.substr(headerEnd + 4, contentLength);
+            conn.in.erase(0, headerEnd + 4 + contentLength);
+
+            size_t lineEnd = head.find("\r\n");
+            std::istringstream requestLine(head.substr(0, lineEnd));
+            std::string target, version;
+            requestLine >> request.method >> target >> version;
+            if (request.method.empty() || target.empty() || target[0] != '/') {
+                HttpResponse error;
+                error.status = 400;
+                error.body = "{\"error\":\"bad request\"}";
+                respond(conn, error, false);
+                return false;
+            }
+
+            size_t question = target.find('?');
+            request.path = decode(target.substr(0, question));
+            if (question != std::string::npos) {
+                parseQuery(target.substr(question + 1), request.params);
+            }
+            std::string connection = headerValue(head, "connection");
+            for (auto& c : connection) c = std::tolower(static_cast<unsigned char>(c));
+            request.keepAlive = version == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+
+            if (pool != nullptr) {
+                handOff(fd, conn, std::move(request));
+                return true;
+            }
+            HttpResponse response;
+            dispatch(request, response);
+            respond(conn, response, request.keepAlive, request.method == "HEAD");
+        }
+        return true;
+    }
+
+    void closeConnection(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections.erase(fd);
+    }
+
+    // Write as much pending output as the socket takes; returns false once
+    // the connection has been closed
+    bool flushOutput(int fd, Connection& conn) {
+        while (conn.outOffset < conn.out.size()) {
+            ssize_t n = send(fd, conn.out.data() + conn.outOffset,
+                             conn.out.size() - conn.outOffset, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if (errno == EINTR) continue;
+                closeConnection(fd);
+                return false;
+            }
+            conn.outOffset += n;
+        }
+        if (conn.outOffset == conn.out.size()) {
+            conn.out.clear();
+            conn.outOffset = 0;
+            if (conn.closeAfterWrite && !conn.busy) {
+                closeConnection(fd);
+                return false;
+            }
+        }
+
+        // Input is not watched while a request is on the pool: nothing reads
+        // it until the response is back, and a peer's half-close would
+        // otherwise report readable on every epoll_wait
+        uint32_t events = conn.busy ? 0u : static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP);
+        if (!conn.out.empty()) events |= EPOLLOUT;
+        if (events != conn.events) {
+            epoll_event ev{};
+            ev.events = events;
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+            conn.events = events;
+        }
+        return true;
+    }
+
+    void acceptConnections() {
+        while (true) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) return; // EAGAIN or a transient error
+            setNonBlocking(fd);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = fd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                close(fd);
+                continue;
+            }
+            Connection conn;
+            conn.id = nextConnectionId++;
+            connections[fd] = std::move(conn);
+        }
+    }
+
+    void readConnection(int fd) {
+        Connection& conn = connections[fd];
+        char buffer[16 * 1024];
+        bool peerClosed = false;
+        while (true) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                conn.in.append(buffer, n);
+                continue;
+            }
+            if (n == 0) peerClosed = true;
+            else if (errno == EINTR) continue;
+            else if (errno != EAGAIN && errno != EWOULDBLOCK) peerClosed = true;
+            break;
+        }
+
+        processInput(fd, conn);
+        if (peerClosed && conn.out.empty() && !conn.busy) {
+            closeConnection(fd);
+            return;
+        }
+        if (peerClosed) conn.closeAfterWrite = true;
+        flushOutput(fd, conn);
+    }
+
+public:
+    // With a pool, handlers run on its workers and must be thread-safe
+    explicit HttpServer(const std::string& root, ThreadPool* workers = nullptr)
+        : staticRoot(root), pool(workers) {}
+
+    ~HttpServer() {
+        while (inFlight.load() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (auto& entry : connections) close(entry.first);
+        if (listenFd >= 0) close(listenFd);
+        if (epollFd >= 0) close(epollFd);
+        if (wakeFd >= 0) close(wakeFd);
+    }
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Percent-decode a URL component ('+' becomes a space)
+    static std::string decode(const std::string& text) {
+        std::string result;
+        result.reserve(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '+') {
+                result += ' ';
+            } else if (text[i] == '%' && i + 2 < text.size() &&
+                       hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+                result += static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+                i += 2;
+            } else {
+                result += text[i];
+            }
+        }
+        return result;
+    }
+
+    static void parseQuery(const std::string& query, std::map<std::string, std::string>& params) {
+        size_t start = 0;
+        while (start < query.size()) {
+            size_t end = query.find('&', start);
+            if (end == std::string::npos) end = query.size();
+            std::string pair = query.substr(start, end - start);
+            size_t eq = pair.find('=');
+            if (eq == std::string::npos) {
+                params[decode(pair)] = "";
+            } else {
+                params[decode(pair.substr(0, eq))] = decode(pair.substr(eq + 1));
+            }
+            start = end + 1;
+        }
+    }
+
+    void route(const std::string& path, Handler handler) {
+        routes[path] = std::move(handler);
+    }
+
+    // Bind to 127.0.0.1:port. Returns false (with a message on stderr) on failure.
+    bool listen(int port) {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            std::cerr << "Error: socket() failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            ::listen(listenFd, SOMAXCONN) < 0) {
+            std::cerr << "Error: cannot listen on port " << port << ": "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+        setNonBlocking(listenFd);
+
+        epollFd = epoll_create1(0);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+
+        wakeFd = eventfd(0, EFD_NONBLOCK);
+        epoll_event wakeEvent{};
+        wakeEvent.events = EPOLLIN;
+        wakeEvent.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &wakeEvent);
+        return true;
+    }
+
+    // Serve until `stop` becomes true (checked at least every 200 ms)
+    void run(const std::atomic<bool>& stop) {
+        epoll_event events[MAX_EVENTS];
+        while (!stop.load()) {
+            int count = epoll_wait(epollFd, events, MAX_EVENTS, 200);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: epoll_wait failed: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            for (int i = 0; i < count; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptConnections();
+                    continue;
+                }
+                if (fd == wakeFd) {
+                    drainCompletions();
+                    continue;
+                }
+                auto conn = connections.find(fd);
+                if (conn == connections.end()) continue;
+                // A hang-up or error is reported whatever is watched; with a
+                // request on the pool the socket is of no further use, and
+                // its completion is dropped once the connection is gone
+                if (conn->second.busy && (events[i].events & (EPOLLHUP | EPOLLERR))) {
+                    closeConnection(fd);
+                    continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    readConnection(fd);
+                } else if (events[i].events & EPOLLOUT) {
+                    flushOutput(fd, conn->second);
+                }
+            }
+        }
+    }
+};
+
+#endif // __linux__
+
+#endif // HTTP_SERVER_H
@@ -0,0 +1,37 @@
+#ifndef LAZY_INDEX_H
+#define LAZY_INDEX_H
+
+#include <cstdint>
+
+// An index derived from the loaded foods, built on first use. Every lazy
+// index of a data set shares one version counter: bumping it when the data
+// changes marks them all out of date, and each is rebuilt on its next use.
+template <typename Index>
+class LazyIndex {
+    Index index;
+    const uint64_t& dataVersion;
+    uint64_t builtVersion = 0;
+    bool built = false;
+
+public:
+    explicit LazyIndex(const uint64_t& version) : dataVersion(version) {}
+
+    bool current() const { return built && builtVersion == dataVersion; }
+
+    // Run `build(index)` unless the index is current; returns whether it ran
+    template <typename Build>
+    bool refresh(Build build) {
+        if (current()) return false;
+        build(index);
+        builtVersion = dataVersion;
+        built = true;
+        return true;
+    }
+
+    Index& operator*() { return index; }
+    const Index& operator*() const { return index; }
+    Index* operator->() { return &index; }
+    const Index* operator->() const { return &index; }
+};
+
+#endif // LAZY_INDEX_H
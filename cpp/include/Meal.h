@@ -0,0 +1,84 @@
+#ifndef MEAL_H
+#define MEAL_H
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include "Food.h"
+#include "FoodTable.h"
+
+// One food of a meal: an id into a FoodTable and the serving in grams
+struct MealItem {
+    FoodId food;
+    float grams;
+};
+
+// A meal as a list of (FoodId, grams). Foods live once in the meal's
+// FoodTable, which clear() empties too, so it never outgrows one meal.
+// Nutrient totals are kept as running sums, updated on every add, remove
+// and serving change, so reading the total or the score never rescans the
+// items.
+class Meal {
+    // Sums are fixed point (millionths) so removing an item subtracts
+    // exactly what adding it added, and edits never drift
+    static constexpr double SCALE = 1e6;
+
+    FoodTable& table;
+    std::vector<MealItem> entries;
+    long long sums[FoodTable::FIELD_COUNT] = {};
+
+    long long contribution(const MealItem& item, int field) const {
+        return std::llround(table.value(item.food, field) * (item.grams / 100.0) * SCALE);
+    }
+
+    void addToSums(const MealItem& item, int sign) {
+        for (int i = 0; i < FoodTable::FIELD_COUNT; i++) sums[i] += sign * contribution(item, i);
+    }
+
+public:
+    explicit Meal(FoodTable& foods) : table(foods) {}
+
+    // Returns the new item's index
+    size_t add(const Food& food, double grams) {
+        entries.push_back({table.intern(food), static_cast<float>(grams)});
+        addToSums(entries.back(), 1);
+        return entries.size() - 1;
+    }
+
+    void setGrams(size_t index, double grams) {
+        addToSums(entries[index], -1);
+        entries[index].grams = static_cast<float>(grams);
+        addToSums(entries[index], 1);
+    }
+
+    // O(1): the last item takes the removed one's index
+    void remove(size_t index) {
+        addToSums(entries[index], -1);
+        entries[index] = entries.back();
+        entries.pop_back();
+    }
+
+    const std::vector<MealItem>& items() const { return entries; }
+    const FoodTable& foods() const { return table; }
+    const std::string& name(size_t index) const { return table.name(entries[index].food); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    void clear() {
+        entries.clear();
+        table.clear();
+        for (auto& sum : sums) sum = 0;
+    }
+
+    // Every item's nutrients for its serving, added up
+    Food total(const std::string& name = "") const {
+        Food sum;
+        sum.name = name;
+        for (int i = 0; i < FoodTable::FIELD_COUNT; i++) sum.*FoodTable::FIELDS[i] = sums[i] / SCALE;
+        return sum;
+    }
+
+    int score() const { return total().calculateScore(); }
+};
+
+#endif // MEAL_H
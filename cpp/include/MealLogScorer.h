@@ -0,0 +1,303 @@
+#ifndef MEAL_LOG_SCORER_H
+#define MEAL_LOG_SCORER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <istream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include "Food.h"
+#include "HashMap.h"
+#include "CSVReader.h"
+#include "OutputBuffer.h"
+
+// Scores an offline meal log: CSV rows of meal_id,food name,grams, up to
+// many millions of them. The log is cut into chunks that worker threads
+// parse, resolve (exact HashMap match, memoized per worker) and aggregate
+// per meal in a hash table; each worker scores and formats the meals that
+// are complete within its chunk. The calling thread reads ahead and writes
+// finished chunks in input order, with at most two chunks per worker in
+// flight, so memory stays bounded whatever the size of the log.
+// The rows of one meal must be contiguous (the log is grouped by meal);
+// a meal that straddles a chunk boundary is stitched back together.
+class MealLogScorer {
+public:
+    struct Stats {
+        size_t rows = 0;
+        size_t meals = 0;
+        size_t unresolved = 0; // rows whose food has no exact match
+        size_t malformed = 0;  // rows without a meal id, food and grams
+    };
+
+private:
+    static const size_t CHUNK_BYTES = 4 << 20;
+    static const size_t MEMO_LIMIT = 1 << 16;
+
+    // One meal's sums so far
+    struct Partial {
+        std::string id;
+        Food total;
+        size_t items = 0;
+        size_t unresolved = 0;
+    };
+
+    // What a worker hands back for one chunk: its first and last meals,
+    // which may continue in the neighbouring chunks, and every meal in
+    // between already formatted
+    struct Result {
+        Partial first;
+        Partial last;
+        bool empty = true;
+        bool single = false;
+        std::string body;
+        size_t middleMeals = 0;
+        size_t rows = 0;
+        size_t unresolved = 0;
+        size_t malformed = 0;
+    };
+
+    const HashMap& hashMap;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::pair<size_t, std::string>> queue; // chunks by sequence number
+    std::map<size_t, Result> finished;
+    bool closed = false;
+
+    // The last meal written so far, which the next chunk may continue
+    Partial carry;
+    bool hasCarry = false;
+
+    static void appendMeal(OutputBuffer& out, const Partial& meal) {
+        if (meal.id.find_first_of(",\"") != std::string::npos) {
+            out.append('"');
+            for (char c : meal.id) {
+                if (c == '"') out.append('"');
+                out.append(c);
+            }
+            out.append('"');
+        } else {
+            out.append(meal.id);
+        }
+        const Food& total = meal.total;
+        out.append(',').append(meal.items)
+           .append(',').append(meal.unresolved)
+           .append(',').appendFixed(total.kcal)
+           .append(',').appendFixed(total.protein)
+           .append(',').appendFixed(total.fat)
+           .append(',').appendFixed(total.carbs)
+           .append(',').appendFixed(total.sugar)
+           .append(',').appendFixed(total.fiber)
+           .append(',').appendFixed(total.satfat)
+           .append(',').appendFixed(total.sodium)
+           .append(',').append(total.calculateScore())
+           .append('\n');
+    }
+
+    // Exact match for `name`, remembered across rows. The memo is dropped
+    // when it grows past MEMO_LIMIT names, to keep memory bounded.
+    const Food* resolve(const std::string& name, std::unordered_map<std::string, const Food*>& memo,
+                        std::vector<const Food*>& matches) const {
+        auto found = memo.find(name);
+        if (found != memo.end()) return found->second;
+        if (memo.size() >= MEMO_LIMIT) memo.clear();
+        matches.clear();
+        hashMap.searchExact(name, matches);
+        const Food* food = matches.empty() ? nullptr : matches[0];
+        memo.emplace(name, food);
+        return food;
+    }
+
+    Result process(const std::string& text, std::unordered_map<std::string, const Food*>& memo) const {
+        Result result;
+        std::vector<Partial> meals;
+        std::unordered_map<std::string, size_t> positions;
+        std::vector<std::string> fields;
+        std::vector<const Food*> matches;
+        std::string line;
+        size_t current = 0;
+
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            line.assign(text, start, end - start);
+            start = end + 1;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            CSVReader::parseLine(line, fields);
+            double grams = fields.size() >= 3 ? CSVReader::toDouble(fields[2]) : 0;
+            if (fields.size() < 3 || fields[0].empty() || grams <= 0) {
+                result.malformed++;
+                continue;
+            }
+            result.rows++;
+
+            // Rows of a meal are usually adjacent; hash only on a change
+            if (meals.empty() || meals[current].id != fields[0]) {
+                auto found = positions.find(fields[0]);
+                if (found == positions.end()) {
+                    positions.emplace(fields[0], meals.size());
+                    meals.emplace_back();
+                    meals.back().id = fields[0];
+                    current = meals.size() - 1;
+                } else {
+                    current = found->second;
+                }
+            }
+            Partial& meal = meals[current];
+            meal.items++;
+            const Food* food = resolve(fields[1], memo, matches);
+            if (food != nullptr) {
+                meal.total.accumulate(*food, grams);
+            } else {
+                meal.unresolved++;
+                result.unresolved++;
+            }
+        }
+        if (meals.empty()) return result;
+
+        result.empty = false;
+        result.single = meals.size() == 1;
+        OutputBuffer body;
+        for (size_t i = 1; i + 1 < meals.size(); i++) appendMeal(body, meals[i]);
+        result.body = body.str();
+        result.middleMeals = meals.size() < 2 ? 0 : meals.size() - 2;
+        result.last = std::move(meals.back());
+        result.first = std::move(meals.front());
+        return result;
+    }
+
+    void workerLoop() {
+        std::unordered_map<std::string, const Food*> memo;
+        while (true) {
+            std::pair<size_t, std::string> chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this]() { return closed || !queue.empty(); });
+                if (queue.empty()) return;
+                chunk = std::move(queue.front());
+                queue.pop_front();
+            }
+            Result result = process(chunk.second, memo);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.emplace(chunk.first, std::move(result));
+            }
+            changed.notify_all();
+        }
+    }
+
+    void emit(OutputBuffer& out, Stats& stats) {
+        if (!hasCarry) return;
+        appendMeal(out, carry);
+        stats.meals++;
+        hasCarry = false;
+    }
+
+    void consume(Result& result, OutputBuffer& out, Stats& stats) {
+        stats.rows += result.rows;
+        stats.unresolved += result.unresolved;
+        stats.malformed += result.malformed;
+        if (result.empty) return;
+
+        if (hasCarry && carry.id == result.first.id) {
+            carry.total.accumulate(result.first.total);
+            carry.items += result.first.items;
+            carry.unresolved += result.first.unresolved;
+        } else {
+            emit(out, stats);
+            carry = std::move(result.first);
+            hasCarry = true;
+        }
+        if (result.single) return;
+
+        emit(out, stats);
+        out.append(result.body);
+        stats.meals += result.middleMeals;
+        carry = std::move(result.last);
+        hasCarry = true;
+    }
+
+public:
+    explicit MealLogScorer(const HashMap& index) : hashMap(index) {}
+
+    // Score every meal in `in` (header line first) onto `out` as CSV
+    Stats run(std::istream& in, OutputBuffer& out, size_t threads) {
+        threads = std::max<size_t>(1, threads);
+        size_t maxInFlight = threads * 2;
+        Stats stats;
+        closed = false;
+        hasCarry = false;
+
+        std::string header;
+        std::getline(in, header);
+        out.append("meal_id,items,unresolved,kcal,protein,fat,carbs,sugar,fiber,satfat,sodium,score\n");
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) workers.emplace_back(&MealLogScorer::workerLoop, this);
+
+        size_t submitted = 0;
+        size_t written = 0;
+        // Write every finished chunk that is next in order; with `block`,
+        // wait for at least one
+        auto drain = [&](bool block) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (block) {
+                changed.wait(lock, [&]() { return finished.count(written) > 0; });
+            }
+            while (true) {
+                auto next = finished.find(written);
+                if (next == finished.end()) return;
+                Result result = std::move(next->second);
+                finished.erase(next);
+                written++;
+                lock.unlock();
+                consume(result, out, stats);
+                lock.lock();
+            }
+        };
+        auto submit = [&](std::string text) {
+            while (submitted - written >= maxInFlight) drain(true);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.emplace_back(submitted++, std::move(text));
+            }
+            changed.notify_all();
+            drain(false);
+        };
+
+        // Chunks end on a line boundary; the partial line starts the next
+        std::string pending;
+        std::vector<char> buffer(CHUNK_BYTES);
+        while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0) {
+            pending.append(buffer.data(), static_cast<size_t>(in.gcount()));
+            size_t cut = pending.rfind('\n');
+            if (cut == std::string::npos) continue;
+            std::string rest = pending.substr(cut + 1);
+            pending.resize(cut + 1);
+            submit(std::move(pending));
+            pending = std::move(rest);
+        }
+        if (!pending.empty()) submit(std::move(pending));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        changed.notify_all();
+        while (written < submitted) drain(true);
+        for (auto& worker : workers) worker.join();
+        emit(out, stats);
+        out.flush();
+        return stats;
+    }
+};
+
+#endif // MEAL_LOG_SCORER_H
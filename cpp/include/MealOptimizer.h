@@ -0,0 +1,367 @@
+#ifndef MEAL_OPTIMIZER_H
+#define MEAL_OPTIMIZER_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cctype>
+#include <functional>
+#include <utility>
+#include "Food.h"
+#include "HashMap.h"
+
+// Suggests changes that raise a meal's score. Each item may be swapped for
+// one of its nearest neighbours in the dataset (foods with a similar
+// energy, protein, fat and carb profile per 100g) and its serving scaled.
+//
+// Plans are found by depth-first branch and bound. Every points table in
+// Food only grows with its nutrient, so scoring the best case of each
+// nutrient on its own (the least energy, sat fat, sugar and sodium and the
+// most protein and fiber the undecided items could still add) bounds the
+// score of every completion of a partial plan; branches that cannot beat
+// the plans already found are cut. The first item's options are searched
+// in parallel, and the search stops at the time budget with the best plans
+// found so far.
+class MealOptimizer {
+public:
+    // One item of a meal: the food (per 100g) and its serving
+    struct Item {
+        Food food;
+        double grams;
+    };
+
+    // The whole meal after the plan, item for item
+    struct Plan {
+        int score = 0;
+        int changes = 0; // swaps plus serving changes
+        std::vector<Item> items;
+    };
+
+    struct Settings {
+        size_t candidates = 4; // substitutes considered per item
+        size_t plans = 3;      // best plans returned
+        long long budgetMs = 50;
+        size_t threads = std::thread::hardware_concurrency();
+        // Share of the original energy a plan must keep; without it,
+        // shrinking every serving would always win
+        double minEnergy = 0.8;
+        double maxEnergy = 1.2;
+    };
+
+    struct Result {
+        int baseline = 0;
+        std::vector<Plan> plans; // best first
+        size_t nodes = 0;        // partial plans visited
+        bool complete = false;   // false if the budget ran out first
+        long long candidateMs = 0;
+        long long searchMs = 0;
+    };
+
+    // Serving changes tried for every item, as multiples of its grams
+    static constexpr double SERVINGS[] = {1.0, 0.8, 0.6, 1.25, 1.5};
+
+private:
+    // The nutrients the score reads: energy, sat fat, sugar and sodium
+    // (fewer points is better), then protein and fiber
+    static const int TERMS = 6;
+    static const int NEGATIVES = 4;
+    // Nutrient change worth one point, used to order the search
+    static constexpr double STEPS[TERMS] = {335 / 4.184, 1, 4.5, 90, 1.6, 0.9};
+
+    // Plans compare by score, then by fewer changes
+    static const long long KEY_SCALE = 1 << 16;
+
+    struct Option {
+        const Food* food;
+        double grams;
+        int changes;
+        double terms[TERMS]; // nutrients of this serving
+    };
+
+    struct Found {
+        long long key;
+        std::vector<unsigned short> choices; // option per depth
+    };
+
+    struct Totals {
+        double terms[TERMS];
+    };
+
+    std::vector<std::vector<Option>> options; // by depth
+    std::vector<size_t> itemAt;               // original index of each depth
+    std::vector<Totals> restMin;              // best case of the depths from here on
+    std::vector<Totals> restMax;
+    double energyLow = 0;
+    double energyHigh = 0;
+    size_t keep = 0;
+
+    std::mutex mutex;
+    std::vector<Found> best; // by key, highest first
+    std::atomic<long long> cutoff{0};
+    std::atomic<bool> stopped{false};
+    std::atomic<size_t> nodeCount{0};
+    std::chrono::steady_clock::time_point deadline;
+
+    static void termsOf(const Food& food, double grams, double* terms) {
+        double multiplier = grams / 100.0;
+        terms[0] = food.kcal * multiplier;
+        terms[1] = food.satfat * multiplier;
+        terms[2] = food.sugar * multiplier;
+        terms[3] = food.sodium * multiplier;
+        terms[4] = food.protein * multiplier;
+        terms[5] = food.fiber * multiplier;
+    }
+
+    static int scoreOf(const double* terms) {
+        Food total;
+        total.kcal = terms[0];
+        total.satfat = terms[1];
+        total.sugar = terms[2];
+        total.sodium = terms[3];
+        total.protein = terms[4];
+        total.fiber = terms[5];
+        return total.calculateScore();
+    }
+
+    static double penalty(const double* terms) {
+        double sum = 0;
+        for (int t = 0; t < TERMS; t++) sum += (t < NEGATIVES ? 1 : -1) * terms[t] / STEPS[t];
+        return sum;
+    }
+
+    static std::string lower(const std::string& str) {
+        std::string result = str;
+        for (char& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    void offer(const std::vector<unsigned short>& choices, long long key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (best.size() == keep && key <= best.back().key) return;
+        auto at = std::find_if(best.begin(), best.end(), [key](const Found& f) { return f.key < key; });
+        best.insert(at, Found{key, choices});
+        if (best.size() > keep) best.pop_back();
+        if (best.size() == keep) cutoff.store(best.back().key);
+    }
+
+    // Highest key any completion of this partial plan could reach, or -1
+    // if none can keep the energy in range
+    long long bound(size_t depth, const double* terms, int changes) const {
+        double low = terms[0] + restMin[depth].terms[0];
+        double high = terms[0] + restMax[depth].terms[0];
+        if (high < energyLow || low > energyHigh) return -1;
+        double bestCase[TERMS];
+        bestCase[0] = std::max(low, energyLow);
+        for (int t = 1; t < TERMS; t++) {
+            bestCase[t] = terms[t] + (t < NEGATIVES ? restMin[depth].terms[t] : restMax[depth].terms[t]);
+        }
+        return scoreOf(bestCase) * KEY_SCALE - changes;
+    }
+
+    void descend(size_t depth, std::vector<Totals>& totals, std::vector<unsigned short>& choices,
+                 int changes, size_t& nodes) {
+        if (stopped.load(std::memory_order_relaxed)) return;
+        if (++nodes % 1024 == 0 && std::chrono::steady_clock::now() > deadline) {
+            stopped.store(true);
+            return;
+        }
+        const double* terms = totals[depth].terms;
+        if (depth == options.size()) {
+            if (terms[0] < energyLow || terms[0] > energyHigh) return;
+            long long key = scoreOf(terms) * KEY_SCALE - changes;
+            if (key > cutoff.load(std::memory_order_relaxed)) offer(choices, key);
+            return;
+        }
+        if (bound(depth, terms, changes) <= cutoff.load(std::memory_order_relaxed)) return;
+
+        for (size_t o = 0; o < options[depth].size(); o++) {
+            const Option& option = options[depth][o];
+            for (int t = 0; t < TERMS; t++) totals[depth + 1].terms[t] = terms[t] + option.terms[t];
+            choices[depth] = static_cast<unsigned short>(o);
+            descend(depth + 1, totals, choices, changes + option.changes, nodes);
+        }
+    }
+
+    // Search the subtrees under the first item's options, taken in turn
+    // from a shared counter
+    void worker(std::atomic<size_t>& nextBranch) {
+        std::vector<Totals> totals(options.size() + 1, Totals{});
+        std::vector<unsigned short> choices(options.size());
+        size_t nodes = 0;
+        size_t branch;
+        while ((branch = nextBranch.fetch_add(1)) < options[0].size() && !stopped.load()) {
+            const Option& option = options[0][branch];
+            for (int t = 0; t < TERMS; t++) totals[1].terms[t] = option.terms[t];
+            choices[0] = static_cast<unsigned short>(branch);
+            descend(1, totals, choices, option.changes, nodes);
+        }
+        nodeCount.fetch_add(nodes);
+    }
+
+public:
+    // The `count` foods nearest to each item by energy, protein, fat and
+    // carbs per 100g: one row per distinct name, never the item's own name
+    static std::vector<std::vector<const Food*>> neighbours(const HashMap& index, const std::vector<Item>& items,
+                                                            size_t count) {
+        // Duplicate names are dropped afterwards, so keep a deeper pool
+        size_t pool = count * 8;
+        auto distance = [](const Food& a, const Food& b) {
+            double kcal = (a.kcal - b.kcal) / 100;
+            double protein = (a.protein - b.protein) / 10;
+            double fat = (a.fat - b.fat) / 10;
+            double carbs = (a.carbs - b.carbs) / 10;
+            return kcal * kcal + protein * protein + fat * fat + carbs * carbs;
+        };
+        using Scored = std::pair<double, const Food*>;
+        std::vector<std::vector<Scored>> heaps(items.size());
+        index.forEach([&](const Food& food) {
+            for (size_t i = 0; i < items.size(); i++) {
+                std::vector<Scored>& heap = heaps[i];
+                double d = distance(items[i].food, food);
+                if (heap.size() == pool && d >= heap.front().first) continue;
+                if (heap.size() == pool) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.pop_back();
+                }
+                heap.emplace_back(d, &food);
+                std::push_heap(heap.begin(), heap.end());
+            }
+        });
+
+        std::vector<std::vector<const Food*>> result(items.size());
+        for (size_t i = 0; i < items.size(); i++) {
+            std::sort_heap(heaps[i].begin(), heaps[i].end());
+            std::vector<std::string> seen{lower(items[i].food.name)};
+            for (const auto& scored : heaps[i]) {
+                if (result[i].size() == count) break;
+                std::string name = lower(scored.second->name);
+                if (std::find(seen.begin(), seen.end(), name) != seen.end()) continue;
+                seen.push_back(name);
+                result[i].push_back(scored.second);
+            }
+        }
+        return result;
+    }
+
+    // Best plans for `meal` that score above it, drawing substitutes from `index`
+    Result optimize(const HashMap& index, const std::vector<Item>& meal, const Settings& settings) {
+        using namespace std::chrono;
+        Result result;
+        if (meal.empty()) return result;
+
+        std::vector<double> baseTerms(TERMS, 0);
+        for (const auto& item : meal) {
+            double terms[TERMS];
+            termsOf(item.food, item.grams, terms);
+            for (int t = 0; t < TERMS; t++) baseTerms[t] += terms[t];
+        }
+        result.baseline = scoreOf(baseTerms.data());
+        result.complete = true;
+        if (result.baseline >= 10 || settings.plans == 0) return result;
+
+        auto start = steady_clock::now();
+        std::vector<std::vector<const Food*>> substitutes = neighbours(index, meal, settings.candidates);
+        auto searchStart = steady_clock::now();
+        result.candidateMs = duration_cast<milliseconds>(searchStart - start).count();
+
+        // Every food of an item at every serving, most promising first
+        std::vector<std::vector<Option>> byItem(meal.size());
+        for (size_t i = 0; i < meal.size(); i++) {
+            std::vector<const Food*> foods{&meal[i].food};
+            foods.insert(foods.end(), substitutes[i].begin(), substitutes[i].end());
+            for (size_t f = 0; f < foods.size(); f++) {
+                for (double step : SERVINGS) {
+                    double grams = std::max(1.0, std::round(meal[i].grams * step));
+                    Option option{foods[f], grams, (f != 0) + (step != 1.0), {}};
+                    termsOf(*foods[f], grams, option.terms);
+                    byItem[i].push_back(option);
+                }
+            }
+            std::stable_sort(byItem[i].begin(), byItem[i].end(), [](const Option& a, const Option& b) {
+                return penalty(a.terms) < penalty(b.terms);
+            });
+        }
+
+        // Items whose options differ most are decided first, so the bound
+        // tightens early
+        auto spread = [&](size_t i) {
+            double sum = 0;
+            for (int t = 0; t < TERMS; t++) {
+                double low = byItem[i][0].terms[t], high = low;
+                for (const auto& option : byItem[i]) {
+                    low = std::min(low, option.terms[t]);
+                    high = std::max(high, option.terms[t]);
+                }
+                sum += (high - low) / STEPS[t];
+            }
+            return sum;
+        };
+        std::vector<double> spreads(meal.size());
+        itemAt.resize(meal.size());
+        for (size_t i = 0; i < meal.size(); i++) {
+            spreads[i] = spread(i);
+            itemAt[i] = i;
+        }
+        std::stable_sort(itemAt.begin(), itemAt.end(), [&](size_t a, size_t b) { return spreads[a] > spreads[b]; });
+        options.clear();
+        for (size_t i : itemAt) options.push_back(std::move(byItem[i]));
+
+        restMin.assign(options.size() + 1, Totals{});
+        restMax.assign(options.size() + 1, Totals{});
+        for (size_t depth = options.size(); depth-- > 0;) {
+            for (int t = 0; t < TERMS; t++) {
+                double low = options[depth][0].terms[t], high = low;
+                for (const auto& option : options[depth]) {
+                    low = std::min(low, option.terms[t]);
+                    high = std::max(high, option.terms[t]);
+                }
+                restMin[depth].terms[t] = restMin[depth + 1].terms[t] + low;
+                restMax[depth].terms[t] = restMax[depth + 1].terms[t] + high;
+            }
+        }
+        energyLow = baseTerms[0] * settings.minEnergy;
+        energyHigh = baseTerms[0] * settings.maxEnergy;
+
+        // Only plans that beat the meal as it is are kept
+        keep = settings.plans;
+        best.clear();
+        cutoff.store(result.baseline * KEY_SCALE);
+        stopped.store(false);
+        nodeCount.store(0);
+        // The budget covers the candidate scan too, so a large dataset
+        // cannot push the answer past it
+        deadline = start + milliseconds(settings.budgetMs);
+
+        size_t threads = std::max<size_t>(1, std::min(settings.threads, options[0].size()));
+        std::atomic<size_t> nextBranch{0};
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; t++) workers.emplace_back(&MealOptimizer::worker, this, std::ref(nextBranch));
+        worker(nextBranch);
+        for (auto& thread : workers) thread.join();
+
+        result.searchMs = duration_cast<milliseconds>(steady_clock::now() - searchStart).count();
+        result.nodes = nodeCount.load();
+        result.complete = !stopped.load();
+        for (const auto& found : best) {
+            Plan plan;
+            plan.items = meal;
+            for (size_t depth = 0; depth < options.size(); depth++) {
+                const Option& option = options[depth][found.choices[depth]];
+                Item& item = plan.items[itemAt[depth]];
+                if (option.food != &meal[itemAt[depth]].food) item.food = *option.food;
+                item.grams = option.grams;
+                plan.changes += option.changes;
+            }
+            plan.score = static_cast<int>((found.key + plan.changes) / KEY_SCALE);
+            result.plans.push_back(std::move(plan));
+        }
+        return result;
+    }
+};
+
+#endif // MEAL_OPTIMIZER_H
@@ -0,0 +1,50 @@
+#ifndef MEAL_SPEC_H
+#define MEAL_SPEC_H
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+// One entry of a textual meal description such as
+// "GREEK YOGURT:150; GRANOLA:40; HONEY"
+struct MealSpecItem {
+    std::string name;
+    double grams;
+};
+
+// Split "<name>:<grams>; <name>:<grams>" into items. Grams default to 100
+// when missing or not a positive number; empty entries are skipped.
+inline std::vector<MealSpecItem> parseMealSpec(const std::string& spec) {
+    auto trim = [](const std::string& str) {
+        size_t first = str.find_first_not_of(" \t\r");
+        if (first == std::string::npos) return std::string();
+        size_t last = str.find_last_not_of(" \t\r");
+        return str.substr(first, last - first + 1);
+    };
+
+    std::vector<MealSpecItem> items;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(';', start);
+        if (end == std::string::npos) end = spec.size();
+        std::string item = trim(spec.substr(start, end - start));
+        start = end + 1;
+        if (item.empty()) continue;
+
+        double grams = 100;
+        size_t colon = item.rfind(':');
+        if (colon != std::string::npos) {
+            std::string amount = trim(item.substr(colon + 1));
+            char* parsedEnd = nullptr;
+            double value = std::strtod(amount.c_str(), &parsedEnd);
+            if (!amount.empty() && parsedEnd != nullptr && *parsedEnd == '\0') {
+                if (value > 0) grams = value;
+                item = trim(item.substr(0, colon));
+            }
+        }
+        items.push_back({item, grams});
+    }
+    return items;
+}
+
+#endif // MEAL_SPEC_H
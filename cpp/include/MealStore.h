@@ -0,0 +1,661 @@
+#ifndef MEAL_STORE_H
+#define MEAL_STORE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include "Food.h"
+#include "FoodTable.h"
+#include "Meal.h"
+
+// A saved meal as it is stored in the log; item ids refer to the store's
+// own food table
+struct StoredMeal {
+    long long id = 0;
+    std::string name;
+    int score = 0;
+    std::vector<MealItem> items;
+};
+
+// A saved meal as the history lists it, without its items
+struct MealSummary {
+    long long id;
+    std::string name;
+    int score;
+    uint32_t itemCount;
+    uint64_t offset; // of the meal record in the log
+    uint32_t bytes;  // size of that record
+};
+
+// Meal history on disk as an append-only log. Records are
+//   F  a food (id, per-100g nutrients, name), written the first time a
+//      meal uses it, so each food is stored once however many meals use it
+//   M  a meal (id, score, name, items as food id + grams)
+//   D  the id of a deleted meal
+// each framed as [type u8][length u32][payload][FNV-1a u32 of payload]; a
+// torn record at the end (a crash mid-write) is cut off on open.
+// "<log>.idx" holds the meal summaries, the food offsets and how much of
+// the log they cover, so opening reads one small file and replays only the
+// records written after it. Deleted meals are garbage until the log is
+// compacted, which happens on open and close once they make up half of it.
+class MealStore {
+    static constexpr char LOG_MAGIC[9] = "MQSLOG1\n";
+    static constexpr char INDEX_MAGIC[9] = "MQSIDX1\n";
+    static const uint64_t HEADER_BYTES = 8;
+    static const size_t RECORD_OVERHEAD = 9; // type, length and checksum
+    static const uint32_t MAX_PAYLOAD = 1 << 26;
+    static const size_t READ_CHUNK = 1 << 20;
+    static const uint64_t COMPACT_MIN_BYTES = 1 << 20;
+
+    std::string path;
+    std::fstream file;
+    uint64_t logBytes = 0;
+    uint64_t garbageBytes = 0;
+    long long nextId = 1;
+
+    std::vector<uint64_t> foodOffsets; // by FoodId
+    FoodTable foods;                   // read from the log when first needed
+    bool foodsLoaded = false;
+
+    std::map<long long, MealSummary> summaries; // by id, so in save order
+
+    // ---- encoding -----------------------------------------------------------
+
+    template <typename T>
+    static void put(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static void putString(std::string& out, const std::string& str) {
+        uint16_t length = static_cast<uint16_t>(std::min<size_t>(str.size(), UINT16_MAX));
+        put(out, length);
+        out.append(str, 0, length);
+    }
+
+    // Bounds-checked reads from one record's payload
+    struct Cursor {
+        const char* data;
+        const char* end;
+        bool ok = true;
+
+        Cursor(const char* d, size_t length) : data(d), end(d + length) {}
+
+        template <typename T>
+        T get() {
+            T value{};
+            if (static_cast<size_t>(end - data) < sizeof(T)) {
+                ok = false;
+                return value;
+            }
+            std::memcpy(&value, data, sizeof(T));
+            data += sizeof(T);
+            return value;
+        }
+
+        std::string getString() {
+            uint16_t length = get<uint16_t>();
+            if (!ok || static_cast<size_t>(end - data) < length) {
+                ok = false;
+                return std::string();
+            }
+            std::string str(data, length);
+            data += length;
+            return str;
+        }
+    };
+
+    static uint32_t checksum(const char* data, size_t length) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    static std::string encodeRecord(char type, const std::string& payload) {
+        std::string record;
+        record.reserve(payload.size() + RECORD_OVERHEAD);
+        record.push_back(type);
+        put(record, static_cast<uint32_t>(payload.size()));
+        record += payload;
+        put(record, checksum(payload.data(), payload.size()));
+        return record;
+    }
+
+    static std::string encodeFood(FoodId id, const Food& food) {
+        std::string payload;
+        put(payload, id);
+        for (double value : {food.kcal, food.protein, food.fat, food.carbs,
+                             food.sugar, food.fiber, food.satfat, food.sodium}) {
+            put(payload, value);
+        }
+        putString(payload, food.name);
+        return payload;
+    }
+
+    static bool decodeFood(Cursor& in, FoodId& id, Food& food) {
+        id = in.get<FoodId>();
+        double* fields[8] = {&food.kcal, &food.protein, &food.fat, &food.carbs,
+                             &food.sugar, &food.fiber, &food.satfat, &food.sodium};
+        for (double* field : fields) *field = in.get<double>();
+        food.name = in.getString();
+        return in.ok;
+    }
+
+    static std::string encodeMeal(const StoredMeal& meal) {
+        std::string payload;
+        put(payload, static_cast<int64_t>(meal.id));
+        put(payload, static_cast<int32_t>(meal.score));
+        put(payload, static_cast<uint32_t>(meal.items.size()));
+        putString(payload, meal.name);
+        for (const auto& item : meal.items) {
+            put(payload, item.food);
+            put(payload, item.grams);
+        }
+        return payload;
+    }
+
+    // Everything but the items, which summaries do not need
+    static bool decodeMealHeader(Cursor& in, StoredMeal& meal, uint32_t& itemCount) {
+        meal.id = in.get<int64_t>();
+        meal.score = in.get<int32_t>();
+        itemCount = in.get<uint32_t>();
+        meal.name = in.getString();
+        return in.ok;
+    }
+
+    static bool decodeMeal(Cursor& in, StoredMeal& meal) {
+        uint32_t count = 0;
+        if (!decodeMealHeader(in, meal, count)) return false;
+        if (count > static_cast<size_t>(in.end - in.data) / (sizeof(FoodId) + sizeof(float))) return false;
+        meal.items.resize(count);
+        for (auto& item : meal.items) {
+            item.food = in.get<FoodId>();
+            item.grams = in.get<float>();
+        }
+        return in.ok;
+    }
+
+    // ---- log access ---------------------------------------------------------
+
+    // Append one record; returns its offset, or UINT64_MAX on failure
+    uint64_t append(char type, const std::string& payload) {
+        std::string record = encodeRecord(type, payload);
+        file.clear();
+        file.seekp(static_cast<std::streamoff>(logBytes));
+        file.write(record.data(), static_cast<std::streamsize>(record.size()));
+        file.flush();
+        if (!file) {
+            std::cerr << "Error: Could not write to " << path << std::endl;
+            return UINT64_MAX;
+        }
+        uint64_t offset = logBytes;
+        logBytes += record.size();
+        return offset;
+    }
+
+    // Read the record at `offset` into `payload`; false if it is damaged
+    bool readRecord(uint64_t offset, char expectedType, std::string& payload) {
+        char header[5];
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset));
+        if (!file.read(header, sizeof(header)) || header[0] != expectedType) return false;
+        uint32_t length;
+        std::memcpy(&length, header + 1, sizeof(length));
+        if (length > MAX_PAYLOAD) return false;
+        payload.resize(length);
+        uint32_t stored;
+        if (!file.read(&payload[0], length) ||
+            !file.read(reinterpret_cast<char*>(&stored), sizeof(stored))) {
+            return false;
+        }
+        return stored == checksum(payload.data(), payload.size());
+    }
+
+    // Make sure `buffer` holds `need` bytes from `pos`, reading more from
+    // `in` a chunk at a time
+    static bool fill(std::ifstream& in, std::string& buffer, size_t& pos, size_t need,
+                     std::vector<char>& chunk) {
+        if (buffer.size() - pos >= need) return true;
+        buffer.erase(0, pos);
+        pos = 0;
+        while (buffer.size() < need) {
+            in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            std::streamsize got = in.gcount();
+            if (got <= 0) return false;
+            buffer.append(chunk.data(), static_cast<size_t>(got));
+        }
+        return true;
+    }
+
+    // Visit every intact record from `from` on, in order, reading the log
+    // sequentially. Returns the offset just past the last intact record.
+    template <typename Fn>
+    uint64_t forEachRecord(uint64_t from, Fn visit) const {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return from;
+        in.seekg(static_cast<std::streamoff>(from));
+
+        std::vector<char> chunk(READ_CHUNK);
+        std::string buffer;
+        size_t pos = 0;
+        uint64_t offset = from;
+        while (fill(in, buffer, pos, 5, chunk)) {
+            char type = buffer[pos];
+            uint32_t length;
+            std::memcpy(&length, buffer.data() + pos + 1, sizeof(length));
+            if (length > MAX_PAYLOAD) break;
+            size_t recordBytes = length + RECORD_OVERHEAD;
+            if (!fill(in, buffer, pos, recordBytes, chunk)) break;
+
+            const char* payload = buffer.data() + pos + 5;
+            uint32_t stored;
+            std::memcpy(&stored, payload + length, sizeof(stored));
+            if (stored != checksum(payload, length)) break;
+
+            visit(type, offset, payload, static_cast<size_t>(length));
+            pos += recordBytes;
+            offset += recordBytes;
+        }
+        return offset;
+    }
+
+    // ---- in-memory state ----------------------------------------------------
+
+    void reset() {
+        logBytes = 0;
+        garbageBytes = 0;
+        nextId = 1;
+        foodOffsets.clear();
+        foods.clear();
+        foodsLoaded = false;
+        summaries.clear();
+    }
+
+    void addSummary(MealSummary summary) {
+        if (summary.id >= nextId) nextId = summary.id + 1;
+        auto existing = summaries.find(summary.id);
+        if (existing != summaries.end()) {
+            garbageBytes += existing->second.bytes;
+            existing->second = std::move(summary);
+            return;
+        }
+        summaries.emplace_hint(summaries.end(), summary.id, std::move(summary));
+    }
+
+    // Returns the size of the removed meal's record, or 0 if there was none
+    uint32_t dropSummary(long long id) {
+        auto found = summaries.find(id);
+        if (found == summaries.end()) return 0;
+        uint32_t bytes = found->second.bytes;
+        summaries.erase(found);
+        return bytes;
+    }
+
+    // Replay one record from the log into the summaries and food offsets
+    void applyRecord(char type, uint64_t offset, const char* data, size_t length) {
+        Cursor in(data, length);
+        uint32_t bytes = static_cast<uint32_t>(length + RECORD_OVERHEAD);
+        if (type == 'F') {
+            FoodId id = in.get<FoodId>();
+            if (in.ok && id == foodOffsets.size()) foodOffsets.push_back(offset);
+        } else if (type == 'M') {
+            StoredMeal meal;
+            uint32_t count = 0;
+            if (decodeMealHeader(in, meal, count)) {
+                addSummary({meal.id, meal.name, meal.score, count, offset, bytes});
+            }
+        } else if (type == 'D') {
+            long long id = in.get<int64_t>();
+            if (in.ok) {
+                garbageBytes += dropSummary(id) + bytes;
+                if (id >= nextId) nextId = id + 1;
+            }
+        }
+    }
+
+    bool loadFoods() {
+        if (foodsLoaded) return true;
+        std::string payload;
+        for (size_t i = 0; i < foodOffsets.size(); i++) {
+            Food food;
+            FoodId id = 0;
+            bool ok = readRecord(foodOffsets[i], 'F', payload);
+            if (ok) {
+                Cursor in(payload.data(), payload.size());
+                ok = decodeFood(in, id, food) && id == i;
+            }
+            if (!ok) {
+                std::cerr << "Error: Damaged food record in " << path << std::endl;
+                foods.clear();
+                return false;
+            }
+            foods.add(food);
+        }
+        foodsLoaded = true;
+        return true;
+    }
+
+    // ---- index file ---------------------------------------------------------
+
+    std::string indexPath() const { return path + ".idx"; }
+
+    // Load the summaries from the index; returns how much of the log they
+    // cover, or HEADER_BYTES (replay everything) if there is no usable index
+    uint64_t readIndex() {
+        std::ifstream in(indexPath(), std::ios::binary | std::ios::ate);
+        if (!in.is_open()) return HEADER_BYTES;
+        std::string data(static_cast<size_t>(in.tellg()), '\0');
+        in.seekg(0);
+        if (data.size() < HEADER_BYTES + sizeof(uint32_t) || !in.read(&data[0], static_cast<std::streamsize>(data.size()))) {
+            return HEADER_BYTES;
+        }
+        size_t bodyBytes = data.size() - sizeof(uint32_t);
+        uint32_t stored;
+        std::memcpy(&stored, data.data() + bodyBytes, sizeof(stored));
+        if (std::memcmp(data.data(), INDEX_MAGIC, HEADER_BYTES) != 0 ||
+            stored != checksum(data.data(), bodyBytes)) {
+            return HEADER_BYTES;
+        }
+
+        Cursor cursor(data.data() + HEADER_BYTES, bodyBytes - HEADER_BYTES);
+        uint64_t covered = cursor.get<uint64_t>();
+        garbageBytes = cursor.get<uint64_t>();
+        nextId = cursor.get<int64_t>();
+        uint32_t foodCount = cursor.get<uint32_t>();
+        for (uint32_t i = 0; i < foodCount && cursor.ok; i++) foodOffsets.push_back(cursor.get<uint64_t>());
+        uint64_t mealCount = cursor.get<uint64_t>();
+        for (uint64_t i = 0; i < mealCount && cursor.ok; i++) {
+            MealSummary summary;
+            summary.id = cursor.get<int64_t>();
+            summary.offset = cursor.get<uint64_t>();
+            summary.bytes = cursor.get<uint32_t>();
+            summary.score = cursor.get<int32_t>();
+            summary.itemCount = cursor.get<uint32_t>();
+            summary.name = cursor.getString();
+            if (cursor.ok) addSummary(std::move(summary));
+        }
+        if (!cursor.ok || covered < HEADER_BYTES || covered > logBytes) {
+            uint64_t size = logBytes;
+            reset();
+            logBytes = size;
+            return HEADER_BYTES;
+        }
+        return covered;
+    }
+
+    // Written to a temporary file and renamed over the old one
+    bool writeIndex() {
+        std::string data(INDEX_MAGIC, HEADER_BYTES);
+        put(data, logBytes);
+        put(data, garbageBytes);
+        put(data, static_cast<int64_t>(nextId));
+        put(data, static_cast<uint32_t>(foodOffsets.size()));
+        for (uint64_t offset : foodOffsets) put(data, offset);
+        put(data, static_cast<uint64_t>(summaries.size()));
+        for (const auto& entry : summaries) {
+            const MealSummary& summary = entry.second;
+            put(data, static_cast<int64_t>(summary.id));
+            put(data, summary.offset);
+            put(data, summary.bytes);
+            put(data, static_cast<int32_t>(summary.score));
+            put(data, summary.itemCount);
+            putString(data, summary.name);
+        }
+        put(data, checksum(data.data(), data.size()));
+
+        std::string temporary = indexPath() + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!out) {
+                std::cerr << "Error: Could not write " << temporary << std::endl;
+                return false;
+            }
+        }
+        return std::rename(temporary.c_str(), indexPath().c_str()) == 0;
+    }
+
+    bool reopen() {
+        file.close();
+        file.clear();
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        return file.is_open();
+    }
+
+    bool needsCompaction() const {
+        return garbageBytes >= COMPACT_MIN_BYTES && garbageBytes * 2 >= logBytes;
+    }
+
+public:
+    MealStore() = default;
+
+    ~MealStore() {
+        close();
+    }
+
+    MealStore(const MealStore&) = delete;
+    MealStore& operator=(const MealStore&) = delete;
+
+    // Open (or create) the log at `filename`. False if it cannot be used.
+    bool open(const std::string& filename) {
+        close();
+        reset();
+        path = filename;
+        if (!std::filesystem::exists(path)) {
+            std::ofstream create(path, std::ios::binary);
+            create.write(LOG_MAGIC, HEADER_BYTES);
+            if (!create) {
+                std::cerr << "Error: Could not create " << path << std::endl;
+                return false;
+            }
+        }
+        if (!reopen()) {
+            std::cerr << "Error: Could not open " << path << std::endl;
+            return false;
+        }
+        char magic[HEADER_BYTES];
+        if (!file.read(magic, HEADER_BYTES) || std::memcmp(magic, LOG_MAGIC, HEADER_BYTES) != 0) {
+            std::cerr << "Error: " << path << " is not a meal history log" << std::endl;
+            file.close();
+            return false;
+        }
+        file.seekg(0, std::ios::end);
+        logBytes = static_cast<uint64_t>(file.tellg());
+
+        uint64_t covered = readIndex();
+        uint64_t end = forEachRecord(covered, [this](char type, uint64_t offset, const char* data, size_t length) {
+            applyRecord(type, offset, data, length);
+        });
+        if (end < logBytes) {
+            std::cerr << "Warning: Dropping " << (logBytes - end) << " damaged bytes at the end of "
+                      << path << std::endl;
+            file.close();
+            std::error_code error;
+            std::filesystem::resize_file(path, end, error);
+            logBytes = end;
+            if (error || !reopen()) {
+                std::cerr << "Error: Could not repair " << path << std::endl;
+                return false;
+            }
+        }
+        if (needsCompaction()) compact();
+        return true;
+    }
+
+    // Write the index (compacting first if worthwhile) and close the log
+    void close() {
+        if (!file.is_open()) return;
+        if (needsCompaction()) compact();
+        writeIndex();
+        file.close();
+    }
+
+    bool isOpen() const { return file.is_open(); }
+
+    // Append a meal; returns its id, or -1 if it could not be written
+    long long save(const std::string& name, const Meal& items, int score) {
+        if (!file.is_open() || !loadFoods()) return -1;
+        StoredMeal meal;
+        meal.id = nextId;
+        meal.name = name;
+        meal.score = score;
+        for (const auto& item : items.items()) {
+            Food food = items.foods().get(item.food);
+            // A new food joins the table only once its F record is written,
+            // so a failed append never leaves an id the log does not define
+            FoodId id = foods.find(food);
+            if (id == foods.size()) {
+                uint64_t offset = append('F', encodeFood(id, food));
+                if (offset == UINT64_MAX) return -1;
+                foods.add(food);
+                foodOffsets.push_back(offset);
+            }
+            meal.items.push_back({id, item.grams});
+        }
+        std::string payload = encodeMeal(meal);
+        uint64_t offset = append('M', payload);
+        if (offset == UINT64_MAX) return -1;
+        addSummary({meal.id, meal.name, meal.score, static_cast<uint32_t>(meal.items.size()), offset,
+                    static_cast<uint32_t>(payload.size() + RECORD_OVERHEAD)});
+        return meal.id;
+    }
+
+    // Read back meal `id` into `into`, adding its foods to the meal's
+    // table; false if there is no such meal
+    bool load(long long id, Meal& into) {
+        auto found = summaries.find(id);
+        if (found == summaries.end() || !loadFoods()) return false;
+        std::string payload;
+        StoredMeal meal;
+        if (!readRecord(found->second.offset, 'M', payload)) return false;
+        Cursor in(payload.data(), payload.size());
+        if (!decodeMeal(in, meal)) return false;
+        for (const auto& item : meal.items) {
+            if (!foods.contains(item.food)) return false;
+        }
+        into.clear();
+        for (const auto& item : meal.items) into.add(foods.get(item.food), item.grams);
+        return true;
+    }
+
+    bool remove(long long id) {
+        if (summaries.find(id) == summaries.end()) return false;
+        std::string payload;
+        put(payload, static_cast<int64_t>(id));
+        if (append('D', payload) == UINT64_MAX) return false;
+        garbageBytes += dropSummary(id) + payload.size() + RECORD_OVERHEAD;
+        return true;
+    }
+
+    // Visit every live meal in log order with one sequential read. Food ids
+    // resolve through foodTable(). Returns the number visited.
+    template <typename Fn>
+    size_t scan(Fn visit) {
+        size_t visited = 0;
+        forEachRecord(HEADER_BYTES, [&](char type, uint64_t offset, const char* data, size_t length) {
+            if (type != 'M') return;
+            Cursor in(data, length);
+            StoredMeal meal;
+            if (!decodeMeal(in, meal)) return;
+            auto found = summaries.find(meal.id);
+            if (found == summaries.end() || found->second.offset != offset) return;
+            visit(meal);
+            visited++;
+        });
+        return visited;
+    }
+
+    // Rewrite the log with only the live meals and the foods they use
+    bool compact() {
+        if (!file.is_open() || !loadFoods()) return false;
+        std::string temporary = path + ".tmp";
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(LOG_MAGIC, HEADER_BYTES);
+
+        FoodTable kept;
+        std::vector<uint64_t> keptOffsets;
+        std::vector<FoodId> remap(foods.size(), UINT32_MAX);
+        std::map<long long, MealSummary> keptSummaries;
+        uint64_t offset = HEADER_BYTES;
+        std::string buffer;
+        auto write = [&](char type, const std::string& payload) {
+            uint64_t at = offset;
+            std::string record = encodeRecord(type, payload);
+            buffer += record;
+            offset += record.size();
+            if (buffer.size() >= READ_CHUNK) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+            return at;
+        };
+
+        // A meal naming a food the log never stored cannot be renumbered;
+        // keep the old log rather than write it with a dangling id
+        size_t missing = 0;
+        scan([&](StoredMeal& meal) {
+            for (auto& item : meal.items) {
+                if (!foods.contains(item.food)) {
+                    missing++;
+                    continue;
+                }
+                if (remap[item.food] == UINT32_MAX) {
+                    remap[item.food] = kept.add(foods.get(item.food));
+                    keptOffsets.push_back(write('F', encodeFood(remap[item.food], foods.get(item.food))));
+                }
+                item.food = remap[item.food];
+            }
+            std::string payload = encodeMeal(meal);
+            uint64_t at = write('M', payload);
+            MealSummary summary = summaries[meal.id];
+            summary.offset = at;
+            summary.bytes = static_cast<uint32_t>(payload.size() + RECORD_OVERHEAD);
+            keptSummaries.emplace_hint(keptSummaries.end(), meal.id, std::move(summary));
+        });
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.close();
+        if (missing > 0) {
+            std::cerr << "Error: " << missing << " meal items in " << path
+                      << " refer to foods it does not store; not compacting" << std::endl;
+            std::remove(temporary.c_str());
+            return false;
+        }
+        if (!out || keptSummaries.size() != summaries.size()) {
+            std::cerr << "Error: Could not compact " << path << std::endl;
+            std::remove(temporary.c_str());
+            return false;
+        }
+
+        // Without the index a crash before it is rewritten means a full
+        // replay, never offsets into the wrong file
+        file.close();
+        std::remove(indexPath().c_str());
+        if (std::rename(temporary.c_str(), path.c_str()) != 0 || !reopen()) {
+            std::cerr << "Error: Could not replace " << path << std::endl;
+            return false;
+        }
+        logBytes = offset;
+        garbageBytes = 0;
+        foods = std::move(kept);
+        foodOffsets = std::move(keptOffsets);
+        summaries = std::move(keptSummaries);
+        return writeIndex();
+    }
+
+    const std::map<long long, MealSummary>& meals() const { return summaries; }
+    const FoodTable& foodTable() { loadFoods(); return foods; }
+    size_t size() const { return summaries.size(); }
+    uint64_t bytes() const { return logBytes; }
+    uint64_t garbage() const { return garbageBytes; }
+    const std::string& filePath() const { return path; }
+};
+
+#endif // MEAL_STORE_H
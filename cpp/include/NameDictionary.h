@@ -0,0 +1,245 @@
+#ifndef NAME_DICTIONARY_H
+#define NAME_DICTIONARY_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include "Food.h"
+#include "FoodTable.h"
+
+// Every distinct name (lowercased) once, sorted and front coded: names are
+// stored in blocks of BLOCK, the first in full and each later one as the
+// length it shares with the name before it plus the rest. Name ids are
+// positions in sorted order, so the names starting with a prefix are one
+// range of ids, found by binary search over the block heads, and the foods
+// under those names are one contiguous slice of FoodIds (grouped by name
+// id, in visiting order within a name). FoodId -> name id goes the other
+// way. It answers exact and prefix queries like Trie in a fraction of the
+// memory; like ScoreIndex it is a snapshot, rebuilt when the data changes.
+class NameDictionary {
+public:
+    static const size_t BLOCK = 16;
+    static const size_t npos = SIZE_MAX;
+
+private:
+    std::vector<unsigned char> bytes; // blocks of varint-prefixed names
+    std::vector<size_t> blockStart;   // offset of each block in bytes
+    size_t nameCount = 0;
+    std::vector<size_t> foodStart;    // nameCount + 1 offsets into foodIds
+    std::vector<FoodId> foodIds;      // grouped by name id
+    std::vector<uint32_t> nameOf;     // name id of each FoodId
+    std::vector<const Food*> foods;   // by FoodId, in visiting order
+
+    static void putLength(std::vector<unsigned char>& out, size_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(value));
+    }
+
+    static size_t getLength(const unsigned char*& in) {
+        size_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            unsigned char byte = *in++;
+            value |= static_cast<size_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) return value;
+        }
+    }
+
+    static std::string lower(std::string_view text) {
+        std::string result(text);
+        for (char& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    // First name of block `b`, stored in full
+    std::string_view head(size_t b) const {
+        const unsigned char* in = bytes.data() + blockStart[b];
+        size_t length = getLength(in);
+        return {reinterpret_cast<const char*>(in), length};
+    }
+
+    // Decode names of block `b` into `name` one at a time, calling
+    // `visit(id, name)` until it returns false; returns the id it stopped at
+    // (or the first id after the block)
+    template <typename Fn>
+    size_t walkBlock(size_t b, std::string& name, Fn visit) const {
+        const unsigned char* in = bytes.data() + blockStart[b];
+        size_t first = b * BLOCK;
+        size_t last = std::min(nameCount, first + BLOCK);
+        for (size_t id = first; id < last; id++) {
+            size_t shared = id == first ? 0 : getLength(in);
+            size_t rest = getLength(in);
+            name.resize(shared);
+            name.append(reinterpret_cast<const char*>(in), rest);
+            in += rest;
+            if (!visit(id, name)) return id;
+        }
+        return last;
+    }
+
+    // First name id for which `before(name)` is false; `before` must hold
+    // for a leading run of the sorted names and nowhere after it
+    template <typename Before>
+    size_t partitionPoint(Before before) const {
+        size_t low = 0, high = blockStart.size();
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (before(head(middle))) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        // Block `low` starts after the boundary; it lies in block low - 1
+        if (low == 0) return 0;
+        std::string name;
+        return walkBlock(low - 1, name, [&before](size_t, const std::string& n) { return before(n); });
+    }
+
+    std::pair<size_t, size_t> prefixRange(const std::string& lowerPrefix) const {
+        size_t first = partitionPoint([&](std::string_view name) { return name < lowerPrefix; });
+        size_t last = partitionPoint(
+            [&](std::string_view name) { return name.compare(0, lowerPrefix.size(), lowerPrefix) <= 0; });
+        return {first, last};
+    }
+
+    void appendFoods(size_t firstName, size_t lastName, std::vector<const Food*>& out) const {
+        for (size_t i = foodStart[firstName]; i < foodStart[lastName]; i++) out.push_back(foods[foodIds[i]]);
+    }
+
+public:
+    template <typename Source>
+    void build(const Source& source) {
+        bytes.clear();
+        blockStart.clear();
+        foods.clear();
+        nameOf.clear();
+
+        // Intern the lowercased names, then sort the distinct ones
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<const std::string*> distinct;
+        std::string key;
+        source.forEach([&](const Food& food) {
+            key.resize(food.name.size());
+            std::transform(food.name.begin(), food.name.end(), key.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            auto inserted = ids.emplace(key, static_cast<uint32_t>(distinct.size()));
+            if (inserted.second) distinct.push_back(&inserted.first->first);
+            foods.push_back(&food);
+            nameOf.push_back(inserted.first->second);
+        });
+        nameCount = distinct.size();
+        std::vector<uint32_t> order(nameCount);
+        for (uint32_t i = 0; i < nameCount; i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return *distinct[a] < *distinct[b]; });
+        std::vector<uint32_t> rank(nameCount);
+        for (uint32_t r = 0; r < nameCount; r++) rank[order[r]] = r;
+
+        const std::string* previous = nullptr;
+        for (uint32_t r = 0; r < nameCount; r++) {
+            const std::string& name = *distinct[order[r]];
+            size_t shared = 0;
+            if (r % BLOCK == 0) {
+                blockStart.push_back(bytes.size());
+            } else {
+                size_t limit = std::min(previous->size(), name.size());
+                while (shared < limit && (*previous)[shared] == name[shared]) shared++;
+                putLength(bytes, shared);
+            }
+            putLength(bytes, name.size() - shared);
+            bytes.insert(bytes.end(), name.begin() + static_cast<std::ptrdiff_t>(shared), name.end());
+            previous = &name;
+        }
+        bytes.shrink_to_fit();
+
+        // Counting sort of the foods by name id
+        for (auto& id : nameOf) id = rank[id];
+        foodStart.assign(nameCount + 1, 0);
+        for (uint32_t id : nameOf) foodStart[id + 1]++;
+        for (size_t n = 0; n < nameCount; n++) foodStart[n + 1] += foodStart[n];
+        std::vector<size_t> next(foodStart.begin(), foodStart.end() - 1);
+        foodIds.resize(foods.size());
+        for (FoodId id = 0; id < foods.size(); id++) foodIds[next[nameOf[id]]++] = id;
+    }
+
+    size_t size() const { return foods.size(); }
+    size_t names() const { return nameCount; }
+
+    // Id of `name` (case-insensitive), or npos
+    size_t find(const std::string& name) const {
+        std::string key = lower(name);
+        size_t id = partitionPoint([&key](std::string_view n) { return n < key; });
+        return id < nameCount && nameAt(id) == key ? id : npos;
+    }
+
+    // The lowercased name with id `id`
+    std::string nameAt(size_t id) const {
+        std::string result;
+        walkBlock(id / BLOCK, result, [id](size_t at, const std::string&) { return at < id; });
+        return result;
+    }
+
+    // Name id of the food numbered `id` in visiting order
+    size_t nameOfFood(FoodId id) const { return nameOf[id]; }
+
+    void searchExact(const std::string& name, std::vector<const Food*>& out) const {
+        size_t id = find(name);
+        if (id != npos) appendFoods(id, id + 1, out);
+    }
+
+    void searchPrefix(const std::string& prefix, std::vector<const Food*>& out) const {
+        auto range = prefixRange(lower(prefix));
+        appendFoods(range.first, range.second, out);
+    }
+
+    // Decodes every distinct name once, so it costs one pass over the
+    // compressed bytes rather than over every food
+    void searchContains(const std::string& term, std::vector<const Food*>& out) const {
+        std::string key = lower(term);
+        std::string name;
+        for (size_t b = 0; b < blockStart.size(); b++) {
+            walkBlock(b, name, [&](size_t id, const std::string& n) {
+                if (n.find(key) != std::string::npos) appendFoods(id, id + 1, out);
+                return true;
+            });
+        }
+    }
+
+    // Up to `limit` distinct names starting with prefix, as spelled by
+    // their first food
+    std::vector<std::string> completeNames(const std::string& prefix, size_t limit) const {
+        std::vector<std::string> result;
+        auto range = prefixRange(lower(prefix));
+        for (size_t id = range.first; id < range.second && result.size() < limit; id++) {
+            result.push_back(foods[foodIds[foodStart[id]]]->name);
+        }
+        return result;
+    }
+
+    // Bytes held by the dictionary and its FoodId mapping
+    size_t bytesUsed() const {
+        return bytes.capacity() + blockStart.capacity() * sizeof(size_t) + foodStart.capacity() * sizeof(size_t) +
+               foodIds.capacity() * sizeof(FoodId) + nameOf.capacity() * sizeof(uint32_t) +
+               foods.capacity() * sizeof(const Food*);
+    }
+
+    // Bytes of the front-coded names alone
+    size_t nameBytes() const { return bytes.capacity(); }
+
+    void printStats() const {
+        std::cout << "\n=== Name Dictionary Statistics ===" << std::endl;
+        std::cout << "Distinct names: " << nameCount << " in " << blockStart.size() << " blocks of " << BLOCK
+                  << std::endl;
+        std::cout << "Front-coded names: " << nameBytes() / 1024 << " KiB, with the FoodId mapping "
+                  << bytesUsed() / 1024 << " KiB" << std::endl;
+    }
+};
+
+#endif // NAME_DICTIONARY_H
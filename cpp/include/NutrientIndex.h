@@ -0,0 +1,113 @@
+#ifndef NUTRIENT_INDEX_H
+#define NUTRIENT_INDEX_H
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include "Food.h"
+#include "FoodTable.h"
+
+// Foods sorted by each nutrient (per 100g), for range queries such as
+// "20-400 kcal with at most 10g sugar". It is a snapshot: build it from an
+// index once that index is complete, and rebuild it after a delta.
+class NutrientIndex {
+public:
+    // Foods whose `field` lies in [low, high]
+    struct Range {
+        double Food::*field;
+        double low;
+        double high;
+    };
+
+private:
+    struct Entry {
+        double value;
+        const Food* food;
+    };
+
+    std::vector<Entry> sorted[FoodTable::FIELD_COUNT];
+
+    static int columnOf(double Food::*field) {
+        for (int i = 0; i < FoodTable::FIELD_COUNT; i++) {
+            if (FoodTable::FIELDS[i] == field) return i;
+        }
+        return -1;
+    }
+
+    // The entries of `column` in [low, high], as an iterator pair
+    std::pair<std::vector<Entry>::const_iterator, std::vector<Entry>::const_iterator>
+    span(int column, double low, double high) const {
+        const std::vector<Entry>& entries = sorted[column];
+        auto first = std::lower_bound(entries.begin(), entries.end(), low,
+                                      [](const Entry& e, double v) { return e.value < v; });
+        auto last = std::upper_bound(first, entries.end(), high,
+                                     [](double v, const Entry& e) { return v < e.value; });
+        return {first, last};
+    }
+
+public:
+    // Index every food `source` visits through forEach; the columns are
+    // sorted on separate threads. Ties keep the visiting order, so the
+    // same data always gives the same index.
+    template <typename Source>
+    void build(const Source& source) {
+        std::vector<const Food*> foods;
+        source.forEach([&foods](const Food& food) { foods.push_back(&food); });
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < FoodTable::FIELD_COUNT; i++) {
+            workers.emplace_back([this, i, &foods]() {
+                std::vector<Entry>& entries = sorted[i];
+                entries.clear();
+                entries.reserve(foods.size());
+                for (const Food* food : foods) entries.push_back({food->*FoodTable::FIELDS[i], food});
+                std::stable_sort(entries.begin(), entries.end(),
+                                 [](const Entry& a, const Entry& b) { return a.value < b.value; });
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+
+    size_t size() const { return sorted[0].size(); }
+
+    size_t count(const Range& range) const {
+        int column = columnOf(range.field);
+        if (column < 0) return 0;
+        auto found = span(column, range.low, range.high);
+        return static_cast<size_t>(found.second - found.first);
+    }
+
+    // Foods inside every range. The narrowest range is read from its
+    // sorted column and the others are checked food by food; results come
+    // in that column's order.
+    void query(const std::vector<Range>& ranges, std::vector<const Food*>& out) const {
+        if (ranges.empty()) return;
+        size_t narrowest = 0;
+        size_t fewest = count(ranges[0]);
+        for (size_t r = 1; r < ranges.size(); r++) {
+            size_t n = count(ranges[r]);
+            if (n < fewest) {
+                fewest = n;
+                narrowest = r;
+            }
+        }
+        int column = columnOf(ranges[narrowest].field);
+        if (column < 0) return;
+        auto found = span(column, ranges[narrowest].low, ranges[narrowest].high);
+        for (auto it = found.first; it != found.second; ++it) {
+            const Food& food = *it->food;
+            bool inside = true;
+            for (const auto& range : ranges) {
+                double value = food.*range.field;
+                if (value < range.low || value > range.high) {
+                    inside = false;
+                    break;
+                }
+            }
+            if (inside) out.push_back(it->food);
+        }
+    }
+};
+
+#endif // NUTRIENT_INDEX_H
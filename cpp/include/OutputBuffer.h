@@ -0,0 +1,170 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <cstdio>
+#include <cmath>
+#include <string>
+
+// Append-only text buffer. With a FILE* it writes through in large blocks
+// and never flushes per line; without one it just builds a string.
+class OutputBuffer {
+    static const size_t DEFAULT_CAPACITY = 1 << 20; // 1 MiB
+    static const size_t STRING_RESERVE = 4096;
+    std::string buffer;
+    std::FILE* sink;
+    size_t capacity;
+
+public:
+    explicit OutputBuffer(std::FILE* out = nullptr, size_t cap = DEFAULT_CAPACITY)
+        : sink(out), capacity(cap) {
+        buffer.reserve(out != nullptr ? cap : STRING_RESERVE);
+    }
+
+    ~OutputBuffer() {
+        flush();
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    OutputBuffer& append(const std::string& text) {
+        buffer += text;
+        spill();
+        return *this;
+    }
+
+    OutputBuffer& append(const char* text) {
+        buffer += text;
+        spill();
+        return *this;
+    }
+
+    OutputBuffer& append(char c) {
+        buffer += c;
+        spill();
+        return *this;
+    }
+
+    OutputBuffer& append(long long value) {
+        char tmp[24];
+        char* end = tmp + sizeof(tmp);
+        unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                                 : static_cast<unsigned long long>(value);
+        char* start = formatDigits(end, magnitude);
+        if (value < 0) *--start = '-';
+        buffer.append(start, end - start);
+        spill();
+        return *this;
+    }
+
+    OutputBuffer& append(int value) {
+        return append(static_cast<long long>(value));
+    }
+
+    OutputBuffer& append(size_t value) {
+        return append(static_cast<long long>(value));
+    }
+
+    // Fixed-point number, e.g. appendFixed(3.14159, 2) -> "3.14". Same text
+    // as printf("%.*f"), but formatted with integer arithmetic whenever the
+    // rounding cannot be in doubt; near-ties, huge values and NaN fall back
+    // to snprintf.
+    OutputBuffer& appendFixed(double value, int digits = 2) {
+        static const double POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+        if (digits >= 0 && digits <= 6) {
+            // Below 2^31 the scaling error is under 2.5e-7, so a fraction
+            // further than 1e-6 from one half rounds the same way as printf
+            double scaled = std::fabs(value) * POW10[digits];
+            if (scaled < 2147483648.0) {
+                double whole = std::floor(scaled);
+                double fraction = scaled - whole;
+                if (std::fabs(fraction - 0.5) > 1e-6) {
+                    unsigned long long units = static_cast<unsigned long long>(whole) + (fraction > 0.5 ? 1 : 0);
+                    char tmp[32];
+                    char* end = tmp + sizeof(tmp);
+                    char* start = end;
+                    for (int i = 0; i < digits; i++) {
+                        *--start = static_cast<char>('0' + units % 10);
+                        units /= 10;
+                    }
+                    if (digits > 0) *--start = '.';
+                    start = formatDigits(start, units);
+                    if (std::signbit(value)) *--start = '-';
+                    buffer.append(start, end - start);
+                    spill();
+                    return *this;
+                }
+            }
+        }
+        char tmp[64];
+        int n = std::snprintf(tmp, sizeof(tmp), "%.*f", digits, value);
+        buffer.append(tmp, n);
+        spill();
+        return *this;
+    }
+
+    // Quoted and escaped JSON string
+    OutputBuffer& appendJsonString(const std::string& text) {
+        buffer += '"';
+        for (unsigned char c : text) {
+            switch (c) {
+                case '"': buffer += "\\\""; break;
+                case '\\': buffer += "\\\\"; break;
+                case '\n': buffer += "\\n"; break;
+                case '\r': buffer += "\\r"; break;
+                case '\t': buffer += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        char tmp[8];
+                        std::snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+                        buffer += tmp;
+                    } else {
+                        buffer += static_cast<char>(c);
+                    }
+            }
+        }
+        buffer += '"';
+        spill();
+        return *this;
+    }
+
+    // TSV field: tabs and newlines inside the value become spaces
+    OutputBuffer& appendTsvField(const std::string& text) {
+        for (char c : text) {
+            buffer += (c == '\t' || c == '\n' || c == '\r') ? ' ' : c;
+        }
+        spill();
+        return *this;
+    }
+
+    const std::string& str() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+    void clear() { buffer.clear(); }
+
+    // Write everything buffered so far to the sink (no-op in string mode)
+    void flush() {
+        if (sink == nullptr || buffer.empty()) return;
+        std::fwrite(buffer.data(), 1, buffer.size(), sink);
+        std::fflush(sink);
+        buffer.clear();
+    }
+
+private:
+    // Write `value` in decimal ending just before `end`; returns its start
+    static char* formatDigits(char* end, unsigned long long value) {
+        do {
+            *--end = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        return end;
+    }
+
+    void spill() {
+        if (sink != nullptr && buffer.size() >= capacity) {
+            std::fwrite(buffer.data(), 1, buffer.size(), sink);
+            buffer.clear();
+        }
+    }
+};
+
+#endif // OUTPUT_BUFFER_H
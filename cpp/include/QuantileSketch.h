@@ -0,0 +1,84 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// Approximate quantiles of non-negative values in a fixed set of
+// log-spaced buckets, read straight from a float's exponent and top
+// mantissa bits, so adding a value is a shift and an increment. Every
+// bucket spans about 1.6% of its lower bound, and sketches built on
+// different threads merge by adding their counts. Values below 2^-10 go
+// to a zero bucket and values from 2^20 up to the last bucket.
+class QuantileSketch {
+    static const int MANTISSA_BITS = 6;
+    static const int MIN_EXPONENT = -10;
+    static const int MAX_EXPONENT = 20;
+    static const size_t BUCKETS = static_cast<size_t>(MAX_EXPONENT - MIN_EXPONENT) << MANTISSA_BITS;
+    static constexpr double SMALLEST = 1.0 / (1 << -MIN_EXPONENT);
+    static constexpr double LARGEST = (1 << MAX_EXPONENT) - 1;
+
+    std::vector<uint64_t> counts;
+    uint64_t zeros = 0;
+    uint64_t total = 0;
+    double low = INFINITY;
+    double high = -INFINITY;
+
+    static double lowerBound(size_t bucket) {
+        int exponent = static_cast<int>(bucket >> MANTISSA_BITS) + MIN_EXPONENT;
+        double mantissa = 1.0 + static_cast<double>(bucket & ((1u << MANTISSA_BITS) - 1)) / (1u << MANTISSA_BITS);
+        return std::ldexp(mantissa, exponent);
+    }
+
+public:
+    QuantileSketch() : counts(BUCKETS, 0) {}
+
+    void add(double value) {
+        total++;
+        low = std::min(low, value);
+        high = std::max(high, value);
+        if (!(value >= SMALLEST)) {
+            zeros++; // also negatives and NaN
+            return;
+        }
+        float single = static_cast<float>(std::min(value, LARGEST));
+        uint32_t bits;
+        std::memcpy(&bits, &single, sizeof(bits));
+        uint32_t biased = static_cast<uint32_t>(MIN_EXPONENT + 127) << MANTISSA_BITS;
+        counts[(bits >> (23 - MANTISSA_BITS)) - biased]++;
+    }
+
+    void merge(const QuantileSketch& other) {
+        for (size_t i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+        zeros += other.zeros;
+        total += other.total;
+        low = std::min(low, other.low);
+        high = std::max(high, other.high);
+    }
+
+    uint64_t count() const { return total; }
+    double min() const { return low; }
+    double max() const { return high; }
+
+    // Value at quantile `q` in [0, 1]: the middle of the bucket holding
+    // it, kept within the smallest and largest value seen
+    double quantile(double q) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(std::llround(q * static_cast<double>(total - 1)));
+        if (rank < zeros) return std::max(low, 0.0);
+        uint64_t seen = zeros;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (rank < seen) {
+                double middle = (lowerBound(i) + lowerBound(i + 1)) / 2;
+                return std::min(high, std::max(low, middle));
+            }
+        }
+        return high;
+    }
+};
+
+#endif // QUANTILE_SKETCH_H
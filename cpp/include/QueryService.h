@@ -0,0 +1,378 @@
+#ifndef QUERY_SERVICE_H
+#define QUERY_SERVICE_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "Food.h"
+#include "HashMap.h"
+#include "Trie.h"
+#include "DataSnapshot.h"
+#include "ScoreIndex.h"
+#include "BrandIndex.h"
+#include "DuplicateIndex.h"
+#include "Snapshot.h"
+#include "OutputBuffer.h"
+#include "MealSpec.h"
+#include "HttpServer.h"
+#include "ThreadPool.h"
+
+// JSON endpoints over the in-memory indexes:
+//
+//   /search?q=<term>&type=exact|prefix|contains&limit=<n>&dedup=1
+//   /complete?q=<prefix>&limit=<n>
+//   /score?name=<exact name>
+//   /meal?items=<name>:<grams>;...   (or the same text as a POST body)
+//   /top?q=<term>&limit=<n>&dedup=1 best-scoring foods whose name contains term
+//   /brand?b=<brand>&min=<score>&limit=<n>   a brand's foods, best first
+//   /brands?q=<prefix>&limit=<n>    brands starting with prefix, with food counts
+//   /stats
+//
+// Handlers may run concurrently on ThreadPool workers. Each request reads
+// the current DataSnapshot without locking and keeps it alive until the
+// response is built, so a reload never pulls data out from under it. Each
+// worker has its own result buffer and counters, and /stats sums the
+// counters when it is asked. With dedup=1, /search and /top list each
+// near-duplicate cluster once, as its representative, and still return up
+// to `limit` results. Clusters are built in the background after a load;
+// until they are ready, results come back as they are, with
+// "deduplicated":false.
+class QueryService {
+    static const size_t DEFAULT_LIMIT = 50;
+    static const size_t MAX_LIMIT = 1000;
+
+    // Written only by the thread owning the slot; padded so neighbouring
+    // workers never share a cache line
+    struct alignas(64) WorkerState {
+        std::vector<const Food*> results;
+        std::atomic<unsigned long long> requests{0};
+        std::atomic<unsigned long long> searchMicros{0};
+        std::atomic<unsigned long long> errors{0};
+    };
+
+    const SnapshotCell<DataSnapshot>& data;
+    const ThreadPool* pool;
+    size_t stateCount;
+    std::unique_ptr<WorkerState[]> states;
+
+    // Slot 0 belongs to threads outside the pool (e.g. the event loop)
+    WorkerState& local() {
+        return states[pool == nullptr ? 0 : pool->currentWorker() + 1];
+    }
+
+    static void bump(std::atomic<unsigned long long>& counter, unsigned long long amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static long long microsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    static size_t limitParam(const HttpRequest& request) {
+        size_t limit = std::strtoul(request.param("limit").c_str(), nullptr, 10);
+        if (limit == 0) limit = DEFAULT_LIMIT;
+        return std::min(limit, MAX_LIMIT);
+    }
+
+    // dedup=1 was asked for and the snapshot's clusters are ready
+    static bool dedupParam(const HttpRequest& request, const DataSnapshot& snapshot) {
+        return request.param("dedup") == "1" && snapshot.nearDuplicatesReady();
+    }
+
+    void error(HttpResponse& response, int status, const char* message) {
+        bump(local().errors, 1);
+        OutputBuffer out;
+        out.append("{\"error\":").appendJsonString(message).append('}');
+        response.status = status;
+        response.body = out.str();
+    }
+
+    static void appendNutrients(OutputBuffer& out, const Food& food) {
+        out.append("\"kcal\":").appendFixed(food.kcal)
+           .append(",\"protein\":").appendFixed(food.protein)
+           .append(",\"fat\":").appendFixed(food.fat)
+           .append(",\"carbs\":").appendFixed(food.carbs)
+           .append(",\"sugar\":").appendFixed(food.sugar)
+           .append(",\"fiber\":").appendFixed(food.fiber)
+           .append(",\"satfat\":").appendFixed(food.satfat)
+           .append(",\"sodium\":").appendFixed(food.sodium);
+    }
+
+public:
+    // `workers` is the pool the handlers will run on (nullptr if none)
+    QueryService(const SnapshotCell<DataSnapshot>& snapshots, const ThreadPool* workers = nullptr)
+        : data(snapshots), pool(workers), stateCount(workers == nullptr ? 1 : workers->size() + 1),
+          states(new WorkerState[stateCount]) {}
+
+    // Full food record plus its score as a JSON object
+    static void appendFood(OutputBuffer& out, const Food& food) {
+        out.append("{\"name\":").appendJsonString(food.name).append(',');
+        appendNutrients(out, food);
+        out.append(",\"score\":").append(food.calculateScore()).append('}');
+    }
+
+    void search(const HttpRequest& request, HttpResponse& response) {
+        std::string query = request.param("q");
+        std::string type = request.param("type", "contains");
+        if (query.empty()) return error(response, 400, "missing q");
+
+        auto snapshot = data.read();
+        WorkerState& state = local();
+        std::vector<const Food*>& results = state.results;
+        results.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        if (type == "exact") {
+            snapshot->hashMap.searchExact(query, results);
+        } else if (type == "prefix") {
+            snapshot->trie.searchPrefix(query, results);
+        } else if (type == "contains") {
+            snapshot->hashMap.searchContains(query, results);
+        } else {
+            return error(response, 400, "type must be exact, prefix or contains");
+        }
+        bool dedup = dedupParam(request, *snapshot);
+        size_t collapsed = dedup ? snapshot->nearDuplicates().collapse(results) : 0;
+        long long micros = microsSince(start);
+        bump(state.searchMicros, micros);
+
+        size_t shown = std::min(limitParam(request), results.size());
+        OutputBuffer out;
+        out.append("{\"query\":").appendJsonString(query)
+           .append(",\"type\":").appendJsonString(type)
+           .append(",\"count\":").append(results.size())
+           .append(",\"deduplicated\":").append(dedup ? "true" : "false")
+           .append(",\"collapsed\":").append(collapsed)
+           .append(",\"micros\":").append(micros)
+           .append(",\"results\":[");
+        for (size_t i = 0; i < shown; i++) {
+            if (i > 0) out.append(',');
+            appendFood(out, *results[i]);
+        }
+        out.append("]}");
+        response.body = out.str();
+    }
+
+    void complete(const HttpRequest& request, HttpResponse& response) {
+        std::string prefix = request.param("q");
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::string> names = data.read()->trie.completeNames(prefix, limitParam(request));
+        long long micros = microsSince(start);
+        bump(local().searchMicros, micros);
+
+        OutputBuffer out;
+        out.append("{\"prefix\":").appendJsonString(prefix)
+           .append(",\"micros\":").append(micros)
+           .append(",\"names\":[");
+        for (size_t i = 0; i < names.size(); i++) {
+            if (i > 0) out.append(',');
+            out.appendJsonString(names[i]);
+        }
+        out.append("]}");
+        response.body = out.str();
+    }
+
+    void score(const HttpRequest& request, HttpResponse& response) {
+        std::string name = request.param("name");
+        if (name.empty()) return error(response, 400, "missing name");
+        auto snapshot = data.read();
+        std::vector<const Food*>& matches = local().results;
+        matches.clear();
+        snapshot->hashMap.searchExact(name, matches);
+        if (matches.empty()) return error(response, 404, "food not found");
+
+        const Food& food = *matches[0];
+        OutputBuffer out;
+        out.append("{\"food\":");
+        appendFood(out, food);
+        out.append(",\"matches\":").append(matches.size())
+           .append(",\"score\":").append(food.calculateScore())
+           .append(",\"feedback\":").appendJsonString(food.getFeedback())
+           .append('}');
+        response.body = out.str();
+    }
+
+    void meal(const HttpRequest& request, HttpResponse& response) {
+        std::string spec = request.param("items", request.body);
+        std::vector<MealSpecItem> items = parseMealSpec(spec);
+        if (items.empty()) return error(response, 400, "missing items");
+
+        Food total;
+        total.name = "meal";
+        auto snapshot = data.read();
+        std::vector<const Food*>& matches = local().results;
+        OutputBuffer out;
+        out.append("{\"items\":[");
+        for (size_t i = 0; i < items.size(); i++) {
+            matches.clear();
+            snapshot->hashMap.searchExact(items[i].name, matches);
+            if (!matches.empty()) {
+                total.accumulate(*matches[0], items[i].grams);
+            }
+            if (i > 0) out.append(',');
+            out.append("{\"name\":").appendJsonString(items[i].name)
+               .append(",\"grams\":").appendFixed(items[i].grams, 1)
+               .append(",\"found\":").append(matches.empty() ? "false" : "true")
+               .append('}');
+        }
+        out.append("],\"total\":{");
+        appendNutrients(out, total);
+        out.append("},\"score\":").append(total.calculateScore())
+           .append(",\"feedback\":").appendJsonString(total.getFeedback())
+           .append('}');
+        response.body = out.str();
+    }
+
+    void top(const HttpRequest& request, HttpResponse& response) {
+        std::string query = request.param("q");
+        auto snapshot = data.read();
+        WorkerState& state = local();
+        std::vector<const Food*>& results = state.results;
+        results.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        ScoreIndex::Filter filter;
+        filter.contains = query;
+        size_t limit = limitParam(request);
+        size_t scanned = snapshot->scores.topByScore(filter, limit, results);
+        size_t collapsed = 0;
+        bool dedup = dedupParam(request, *snapshot);
+        if (dedup) {
+            // Collapsing can leave fewer than `limit`: ask for twice as many
+            // until enough clusters remain or the matches run out
+            const DuplicateIndex& duplicates = snapshot->nearDuplicates();
+            for (size_t fetch = limit;; fetch *= 2) {
+                bool exhausted = results.size() < fetch;
+                collapsed = duplicates.collapse(results);
+                if (results.size() >= limit || exhausted) break;
+                results.clear();
+                scanned = snapshot->scores.topByScore(filter, fetch * 2, results);
+            }
+            if (results.size() > limit) results.resize(limit);
+        }
+        long long micros = microsSince(start);
+        bump(state.searchMicros, micros);
+
+        OutputBuffer out;
+        out.append("{\"query\":").appendJsonString(query)
+           .append(",\"count\":").append(results.size())
+           .append(",\"scanned\":").append(scanned)
+           .append(",\"deduplicated\":").append(dedup ? "true" : "false")
+           .append(",\"collapsed\":").append(collapsed)
+           .append(",\"micros\":").append(micros)
+           .append(",\"results\":[");
+        for (size_t i = 0; i < results.size(); i++) {
+            if (i > 0) out.append(',');
+            appendFood(out, *results[i]);
+        }
+        out.append("]}");
+        response.body = out.str();
+    }
+
+    void brand(const HttpRequest& request, HttpResponse& response) {
+        std::string name = request.param("b");
+        if (name.empty()) return error(response, 400, "missing b");
+        int minScore = std::atoi(request.param("min", "1").c_str());
+        auto snapshot = data.read();
+        WorkerState& state = local();
+        std::vector<const Food*>& results = state.results;
+        results.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        size_t count = snapshot->brands.fromBrand(name, minScore, limitParam(request), results);
+        long long micros = microsSince(start);
+        bump(state.searchMicros, micros);
+
+        OutputBuffer out;
+        out.append("{\"brand\":").appendJsonString(name)
+           .append(",\"min\":").append(minScore)
+           .append(",\"count\":").append(count)
+           .append(",\"micros\":").append(micros)
+           .append(",\"results\":[");
+        for (size_t i = 0; i < results.size(); i++) {
+            if (i > 0) out.append(',');
+            appendFood(out, *results[i]);
+        }
+        out.append("]}");
+        response.body = out.str();
+    }
+
+    void brands(const HttpRequest& request, HttpResponse& response) {
+        std::string prefix = request.param("q");
+        std::vector<BrandIndex::Brand> found;
+        auto start = std::chrono::steady_clock::now();
+        data.read()->brands.brandsStartingWith(prefix, limitParam(request), found);
+        long long micros = microsSince(start);
+        bump(local().searchMicros, micros);
+
+        OutputBuffer out;
+        out.append("{\"prefix\":").appendJsonString(prefix)
+           .append(",\"micros\":").append(micros)
+           .append(",\"brands\":[");
+        for (size_t i = 0; i < found.size(); i++) {
+            if (i > 0) out.append(',');
+            out.append("{\"name\":").appendJsonString(found[i].name)
+               .append(",\"foods\":").append(found[i].foods)
+               .append('}');
+        }
+        out.append("]}");
+        response.body = out.str();
+    }
+
+    void stats(const HttpRequest&, HttpResponse& response) {
+        unsigned long long requestCount = 0, searchMicros = 0, errorCount = 0;
+        for (size_t i = 0; i < stateCount; i++) {
+            requestCount += states[i].requests.load(std::memory_order_relaxed);
+            searchMicros += states[i].searchMicros.load(std::memory_order_relaxed);
+            errorCount += states[i].errors.load(std::memory_order_relaxed);
+        }
+        auto snapshot = data.read();
+        const LoadStats& loadStats = snapshot->stats;
+        // Zero until the background build has finished
+        DuplicateIndex::Stats duplicates;
+        bool dedupReady = snapshot->nearDuplicatesReady();
+        if (dedupReady) duplicates = snapshot->nearDuplicates().stats();
+        OutputBuffer out;
+        out.append("{\"foods\":").append(loadStats.foods)
+           .append(",\"version\":").append(static_cast<long long>(snapshot->version))
+           .append(",\"hashMapBuildMs\":").append(loadStats.hashMapBuildMs)
+           .append(",\"trieBuildMs\":").append(loadStats.trieBuildMs)
+           .append(",\"indexBuildMs\":").append(loadStats.indexBuildMs)
+           .append(",\"duplicates\":").append(duplicates.duplicates)
+           .append(",\"duplicateClusters\":").append(duplicates.clusters)
+           .append(",\"dedupMs\":").append(duplicates.millis)
+           .append(",\"dedupReady\":").append(dedupReady ? "true" : "false")
+           .append(",\"requests\":").append(static_cast<long long>(requestCount))
+           .append(",\"searchMicros\":").append(static_cast<long long>(searchMicros))
+           .append(",\"errors\":").append(static_cast<long long>(errorCount))
+           .append(",\"workers\":").append(stateCount - 1)
+           .append('}');
+        response.body = out.str();
+    }
+
+#if defined(__linux__)
+    void registerRoutes(HttpServer& server) {
+        auto bind = [this](void (QueryService::*method)(const HttpRequest&, HttpResponse&)) {
+            return [this, method](const HttpRequest& request, HttpResponse& response) {
+                bump(local().requests, 1);
+                (this->*method)(request, response);
+            };
+        };
+        server.route("/search", bind(&QueryService::search));
+        server.route("/complete", bind(&QueryService::complete));
+        server.route("/score", bind(&QueryService::score));
+        server.route("/meal", bind(&QueryService::meal));
+        server.route("/top", bind(&QueryService::top));
+        server.route("/brand", bind(&QueryService::brand));
+        server.route("/brands", bind(&QueryService::brands));
+        server.route("/stats", bind(&QueryService::stats));
+    }
+#endif
+};
+
+#endif // QUERY_SERVICE_H
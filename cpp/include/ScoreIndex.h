@@ -0,0 +1,122 @@
+#ifndef SCORE_INDEX_H
+#define SCORE_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include "Food.h"
+#include "FoodTable.h"
+#include "NutrientIndex.h"
+
+// Foods grouped by score, for "the N healthiest foods matching X". Each of
+// the ten scores keeps a list of FoodIds, and names are kept lowercased
+// back to back, so a query walks the buckets from 10 down, checks each
+// food's name and nutrients in place, and stops after the bucket that
+// fills N. Within a bucket the best matches are kept in a bounded heap of
+// the places still open; ties are broken by the unclamped points, then
+// protein, fiber and sodium, then name. Like NutrientIndex it is a
+// snapshot: rebuild it when the data changes.
+class ScoreIndex {
+public:
+    struct Filter {
+        std::string contains;                    // case-insensitive; empty matches all
+        std::vector<NutrientIndex::Range> ranges; // per 100g, all must hold
+    };
+
+    static const int MAX_SCORE = 10;
+
+private:
+    struct Ranked {
+        int points; // positive minus negative points, before clamping
+        FoodId id;
+    };
+
+    std::vector<const Food*> foods; // by FoodId, in visiting order
+    std::vector<int> points;
+    std::string names;
+    std::vector<size_t> nameStart; // foods.size() + 1 offsets into names
+    std::vector<FoodId> buckets[MAX_SCORE + 1];
+
+    // True if `a` ranks ahead of `b`
+    bool better(const Ranked& a, const Ranked& b) const {
+        if (a.points != b.points) return a.points > b.points;
+        const Food& x = *foods[a.id];
+        const Food& y = *foods[b.id];
+        if (x.protein != y.protein) return x.protein > y.protein;
+        if (x.fiber != y.fiber) return x.fiber > y.fiber;
+        if (x.sodium != y.sodium) return x.sodium < y.sodium;
+        if (x.name != y.name) return x.name < y.name;
+        return a.id < b.id;
+    }
+
+    bool matches(FoodId id, const std::string& lowerTerm, const std::vector<NutrientIndex::Range>& ranges) const {
+        for (const auto& range : ranges) {
+            double value = foods[id]->*range.field;
+            if (value < range.low || value > range.high) return false;
+        }
+        if (lowerTerm.empty()) return true;
+        std::string_view name(names.data() + nameStart[id], nameStart[id + 1] - nameStart[id]);
+        return name.find(lowerTerm) != std::string_view::npos;
+    }
+
+public:
+    template <typename Source>
+    void build(const Source& source) {
+        foods.clear();
+        points.clear();
+        names.clear();
+        nameStart.assign(1, 0);
+        for (auto& bucket : buckets) bucket.clear();
+        source.forEach([this](const Food& food) {
+            FoodId id = static_cast<FoodId>(foods.size());
+            // Same clamp as calculateScore, without scoring twice
+            int net = food.calculatePositivePoints() - food.calculateNegativePoints();
+            int score = std::min(MAX_SCORE, std::max(1, 10 + net));
+            foods.push_back(&food);
+            points.push_back(net);
+            buckets[score].push_back(id);
+            for (char c : food.name) names.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+            nameStart.push_back(names.size());
+        });
+    }
+
+    size_t size() const { return foods.size(); }
+    size_t bucketSize(int score) const { return buckets[score].size(); }
+
+    // The `n` best foods passing `filter`, best first, appended to `out`.
+    // Returns how many foods were looked at.
+    size_t topByScore(const Filter& filter, size_t n, std::vector<const Food*>& out) const {
+        std::string lowerTerm = filter.contains;
+        for (char& c : lowerTerm) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        auto rankedAhead = [this](const Ranked& a, const Ranked& b) { return better(a, b); };
+
+        size_t scanned = 0;
+        size_t found = 0;
+        std::vector<Ranked> heap; // worst kept match on top
+        for (int score = MAX_SCORE; score >= 1 && found < n; score--) {
+            size_t room = n - found;
+            heap.clear();
+            for (FoodId id : buckets[score]) {
+                scanned++;
+                if (!matches(id, lowerTerm, filter.ranges)) continue;
+                Ranked ranked{points[id], id};
+                if (heap.size() < room) {
+                    heap.push_back(ranked);
+                    std::push_heap(heap.begin(), heap.end(), rankedAhead);
+                } else if (better(ranked, heap.front())) {
+                    std::pop_heap(heap.begin(), heap.end(), rankedAhead);
+                    heap.back() = ranked;
+                    std::push_heap(heap.begin(), heap.end(), rankedAhead);
+                }
+            }
+            std::sort_heap(heap.begin(), heap.end(), rankedAhead);
+            for (const auto& ranked : heap) out.push_back(foods[ranked.id]);
+            found += heap.size();
+        }
+        return scanned;
+    }
+};
+
+#endif // SCORE_INDEX_H
@@ -0,0 +1,92 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Holds the current version of an immutable object and swaps in new
+// versions RCU-style. Readers never lock: they register in one of two
+// reader counters, load the pointer, and deregister when done. A publisher
+// swaps the pointer, flips which counter new readers use, and waits for the
+// old counter to drain before deleting the previous version, so in-flight
+// readers always finish on the version they started with.
+template <typename T>
+class SnapshotCell {
+    struct alignas(64) Counter {
+        std::atomic<size_t> readers{0};
+    };
+
+    std::atomic<T*> current{nullptr};
+    mutable std::atomic<unsigned> parity{0};
+    mutable Counter counters[2];
+    std::mutex publishing; // one publisher at a time
+    std::atomic<unsigned long long> published{0};
+
+public:
+    // Keeps one version alive for as long as it is in scope
+    class ReadGuard {
+        const SnapshotCell* cell;
+        unsigned slot;
+        const T* value;
+
+    public:
+        ReadGuard(const SnapshotCell* c, unsigned s, const T* v) : cell(c), slot(s), value(v) {}
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard(ReadGuard&& other) noexcept : cell(other.cell), slot(other.slot), value(other.value) {
+            other.cell = nullptr;
+        }
+        ~ReadGuard() {
+            if (cell != nullptr) cell->counters[slot].readers.fetch_sub(1, std::memory_order_release);
+        }
+
+        const T* get() const { return value; }
+        const T& operator*() const { return *value; }
+        const T* operator->() const { return value; }
+        explicit operator bool() const { return value != nullptr; }
+    };
+
+    SnapshotCell() = default;
+    explicit SnapshotCell(std::unique_ptr<T> initial) : current(initial.release()) {}
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    ~SnapshotCell() {
+        delete current.load();
+    }
+
+    ReadGuard read() const {
+        while (true) {
+            unsigned slot = parity.load();
+            counters[slot].readers.fetch_add(1);
+            // If a publisher flipped in between, our counter may already
+            // have been waited on; retry on the new one
+            if (parity.load() == slot) {
+                return ReadGuard(this, slot, current.load());
+            }
+            counters[slot].readers.fetch_sub(1);
+        }
+    }
+
+    // Make `next` current and free the previous version once no reader is
+    // still using it. Blocks only the publisher.
+    void publish(std::unique_ptr<T> next) {
+        std::lock_guard<std::mutex> lock(publishing);
+        T* previous = current.exchange(next.release());
+        unsigned old = parity.load();
+        parity.store(old ^ 1u);
+        while (counters[old].readers.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        delete previous;
+        published.fetch_add(1);
+    }
+
+    // Number of publish() calls so far
+    unsigned long long versions() const { return published.load(); }
+};
+
+#endif // SNAPSHOT_H
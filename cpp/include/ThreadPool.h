@@ -0,0 +1,134 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Fixed-size worker pool with one task deque per worker. A worker pops its
+// own newest task first and, when empty, steals the oldest task from the
+// other workers, so bursts submitted to one queue spread across all cores.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<bool> stopping{false};
+
+    // Which pool the calling thread works for, and its index there; one per
+    // thread, so a worker of another pool is not mistaken for one of ours
+    struct WorkerSlot {
+        const ThreadPool* pool = nullptr;
+        int index = -1;
+    };
+
+    static WorkerSlot& workerSlot() {
+        thread_local WorkerSlot slot;
+        return slot;
+    }
+
+    bool popLocal(size_t index, Task& task) {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t thief, Task& task) {
+        for (size_t offset = 1; offset < queues.size(); offset++) {
+            Queue& queue = *queues[(thief + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        workerSlot() = {this, static_cast<int>(index)};
+        while (true) {
+            Task task;
+            if (popLocal(index, task) || steal(index, task)) {
+                pending.fetch_sub(1);
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return pending.load() > 0 || stopping.load(); });
+            if (stopping.load() && pending.load() == 0) return;
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency()) {
+        if (threadCount == 0) threadCount = 1;
+        for (size_t i = 0; i < threadCount; i++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < threadCount; i++) {
+            threads.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+
+    // Runs every task already submitted, then joins the workers
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping.store(true);
+        }
+        wake.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return threads.size(); }
+
+    // Index of the calling worker in [0, size()), or -1 off this pool
+    int currentWorker() const {
+        const WorkerSlot& slot = workerSlot();
+        return slot.pool == this ? slot.index : -1;
+    }
+
+    // Queue a task. Tasks submitted from a worker go to that worker's own
+    // deque; tasks from other threads are spread round-robin.
+    void submit(Task task) {
+        int self = currentWorker();
+        size_t index = self >= 0 ? static_cast<size_t>(self)
+                                 : nextQueue.fetch_add(1) % queues.size();
+        // Count the task only once it can be popped, or a woken worker finds
+        // nothing and spins; both locks are held so no worker can pop it
+        // before it is counted or miss the wake-up
+        {
+            std::lock_guard<std::mutex> sleepLock(sleepMutex);
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+            pending.fetch_add(1);
+        }
+        wake.notify_one();
+    }
+};
+
+#endif // THREAD_POOL_H
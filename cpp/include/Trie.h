@@ -5,17 +5,28 @@
 #include <vector>
 #include <algorithm>
 #include <cctype>
-#include <memory>
+#include <numeric>
+#include <thread>
 #include "Food.h"
+#include "Arena.h"
 
+// One entry in a node's list of foods; lives in the trie's arena
+struct FoodLink {
+    const Food* food;
+    FoodLink* next;
+};
+
+// Nodes are allocated from the trie's arena and never freed one by one,
+// so they hold raw pointers and must stay trivially destructible
 class TrieNode {
 public:
     static const int ALPHABET_SIZE = 27; // 26 letters + space/special char
-    std::unique_ptr<TrieNode> children[ALPHABET_SIZE];
-    std::vector<Food> foods; // Store all foods that end at this node
+    TrieNode* children[ALPHABET_SIZE];
+    FoodLink* foods;     // Store all foods that end at this node
+    FoodLink* lastFood;  // tail of `foods`, so inserts keep file order
     bool isEndOfWord;
 
-    TrieNode() : isEndOfWord(false) {
+    TrieNode() : foods(nullptr), lastFood(nullptr), isEndOfWord(false) {
         for (int i = 0; i < ALPHABET_SIZE; i++) {
             children[i] = nullptr;
         }
@@ -33,7 +44,64 @@ public:
 
 class Trie {
 private:
-    std::unique_ptr<TrieNode> root;
+    // Nodes and records for one builder thread; insert() uses the first
+    struct Storage {
+        Arena nodes;
+        RecordPool<Food> records;
+    };
+
+    std::vector<Storage> storage;
+    TrieNode* root;
+
+    // Walk/extend the path for key[from..] below `start`, then add the food
+    // (stored in the pool with `copy`, otherwise referenced)
+    void insertBelow(TrieNode* start, const std::string& key, size_t from,
+                     const Food& food, Storage& into, bool copy) {
+        TrieNode* current = start;
+        for (size_t k = from; k < key.size(); k++) {
+            int index = TrieNode::charToIndex(key[k]);
+            if (current->children[index] == nullptr) {
+                current->children[index] = into.nodes.create<TrieNode>();
+            }
+            current = current->children[index];
+        }
+
+        current->isEndOfWord = true;
+        const Food* record = copy ? into.records.add(food) : &food;
+        FoodLink* link = into.nodes.create<FoodLink>(FoodLink{record, nullptr});
+        if (current->lastFood != nullptr) {
+            current->lastFood->next = link;
+        } else {
+            current->foods = link;
+        }
+        current->lastFood = link;
+    }
+
+    // Drop `link` (whose predecessor is `prev`) from the node's list; its
+    // `next` is left intact so a loop over the list can continue past it
+    static void unlink(TrieNode* node, FoodLink* prev, FoodLink* link) {
+        if (prev != nullptr) {
+            prev->next = link->next;
+        } else {
+            node->foods = link->next;
+        }
+        if (node->lastFood == link) node->lastFood = prev;
+    }
+
+    static std::vector<Food> copyFoods(const TrieNode* node) {
+        std::vector<Food> results;
+        for (const FoodLink* link = node->foods; link != nullptr; link = link->next) {
+            results.push_back(*link->food);
+        }
+        return results;
+    }
+
+    // Lowercase into a reused buffer, so bulk builds do not allocate a key per food
+    static void lowerInto(std::string& out, const std::string& str) {
+        out.resize(str.size());
+        std::transform(str.begin(), str.end(), out.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+    }
 
     // Helper function to convert string to lowercase
     std::string toLower(const std::string& str) const {
@@ -48,64 +116,278 @@ private:
         if (node == nullptr) return;
 
         // Add foods at this node
-        for (const auto& food : node->foods) {
-            results.push_back(food);
+        for (const FoodLink* link = node->foods; link != nullptr; link = link->next) {
+            results.push_back(*link->food);
         }
 
         // Recursively collect from all children
         for (int i = 0; i < TrieNode::ALPHABET_SIZE; i++) {
             if (node->children[i] != nullptr) {
-                collectAllFoods(node->children[i].get(), results);
+                collectAllFoods(node->children[i], results);
+            }
+        }
+    }
+
+    void collectAllFoods(const TrieNode* node, std::vector<const Food*>& results) const {
+        for (const FoodLink* link = node->foods; link != nullptr; link = link->next) {
+            results.push_back(link->food);
+        }
+        for (int i = 0; i < TrieNode::ALPHABET_SIZE; i++) {
+            if (node->children[i] != nullptr) {
+                collectAllFoods(node->children[i], results);
+            }
+        }
+    }
+
+    const TrieNode* findNode(const std::string& lowerKey) const {
+        const TrieNode* current = root;
+        for (char c : lowerKey) {
+            current = current->children[TrieNode::charToIndex(c)];
+            if (current == nullptr) return nullptr;
+        }
+        return current;
+    }
+
+    // Depth-first walk that stops once `limit` distinct names are collected
+    void collectNames(const TrieNode* node, size_t limit, std::vector<std::string>& names) const {
+        if (names.size() >= limit) return;
+        if (node->isEndOfWord && node->foods != nullptr) {
+            names.push_back(node->foods->food->name);
+        }
+        for (int i = 0; i < TrieNode::ALPHABET_SIZE && names.size() < limit; i++) {
+            if (node->children[i] != nullptr) {
+                collectNames(node->children[i], limit, names);
             }
         }
     }
 
 public:
-    Trie() {
-        root = std::make_unique<TrieNode>();
+    Trie() : storage(1) {
+        root = storage[0].nodes.create<TrieNode>();
     }
 
     // Insert a food item
     void insert(const Food& food) {
-        std::string key = toLower(food.name);
-        TrieNode* current = root.get();
+        insertBelow(root, toLower(food.name), 0, food, storage[0], true);
+    }
+
+    // Bulk insert on several threads. Each root child (first character) is
+    // a separate subtree; subtrees are dealt to threads largest first and
+    // built with that thread's own arena, then hang off the shared root.
+    // Threads never touch the same node, so no locking is needed.
+    void insertAll(const std::vector<Food>& foods, size_t threads = std::thread::hardware_concurrency()) {
+        insertAll(foods.data(), foods.size(), threads);
+    }
+
+    // Same for foods[0..count); calling it on consecutive slices gives the
+    // same result as one call, and the per-thread storage is reused
+    void insertAll(const Food* foods, size_t count, size_t threads) {
+        bulkInsert(foods, count, threads, true);
+    }
+
+    // Like insertAll, but the trie points at the caller's records instead
+    // of copying them. They must not move and must outlive the Trie.
+    void indexAll(const Food* foods, size_t count, size_t threads) {
+        bulkInsert(foods, count, threads, false);
+    }
+
+private:
+    void bulkInsert(const Food* foods, size_t count, size_t threads, bool copy) {
+        if (threads == 0) threads = 1;
+        threads = std::min(threads, std::max<size_t>(1, count / 1024));
+        std::string key;
+        if (threads == 1) {
+            for (size_t i = 0; i < count; i++) {
+                lowerInto(key, foods[i].name);
+                insertBelow(root, key, 0, foods[i], storage[0], copy);
+            }
+            return;
+        }
+
+        // Empty names end at the root itself
+        std::vector<size_t> perChild(TrieNode::ALPHABET_SIZE, 0);
+        for (size_t i = 0; i < count; i++) {
+            const Food& food = foods[i];
+            if (food.name.empty()) {
+                insertBelow(root, food.name, 0, food, storage[0], copy);
+            } else {
+                perChild[TrieNode::charToIndex(food.name[0])]++;
+            }
+        }
+
+        std::vector<int> order(TrieNode::ALPHABET_SIZE);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&perChild](int a, int b) { return perChild[a] > perChild[b]; });
+        std::vector<int> owner(TrieNode::ALPHABET_SIZE);
+        std::vector<size_t> load(threads, 0);
+        for (int child : order) {
+            size_t least = std::min_element(load.begin(), load.end()) - load.begin();
+            owner[child] = static_cast<int>(least);
+            load[least] += perChild[child];
+        }
+
+        if (storage.size() < threads + 1) storage.resize(threads + 1);
+        auto work = [&](size_t t) {
+            Storage& into = storage[1 + t];
+            std::string key;
+            for (size_t i = 0; i < count; i++) {
+                const Food& food = foods[i];
+                if (food.name.empty()) continue;
+                int child = TrieNode::charToIndex(food.name[0]);
+                if (owner[child] != static_cast<int>(t)) continue;
+                if (root->children[child] == nullptr) {
+                    root->children[child] = into.nodes.create<TrieNode>();
+                }
+                lowerInto(key, food.name);
+                insertBelow(root->children[child], key, 1, food, into, copy);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; t++) workers.emplace_back(work, t);
+        work(0);
+        for (auto& worker : workers) worker.join();
+    }
 
+public:
+
+    // Replace every food whose name equals food.name ignoring case by one
+    // copy of `food`, or add it if there is none. Returns how many foods
+    // had the name (0 if it was added). Superseded records stay in the
+    // arena and pool until the trie is destroyed.
+    size_t upsert(const Food& food) {
+        std::string key = toLower(food.name);
+        TrieNode* node = root;
         for (char c : key) {
             int index = TrieNode::charToIndex(c);
-            if (current->children[index] == nullptr) {
-                current->children[index] = std::make_unique<TrieNode>();
+            if (node->children[index] == nullptr) {
+                node->children[index] = storage[0].nodes.create<TrieNode>();
             }
-            current = current->children[index].get();
+            node = node->children[index];
         }
 
-        current->isEndOfWord = true;
-        current->foods.push_back(food);
+        // Other names can share the node (punctuation maps to one slot)
+        const Food* record = storage[0].records.add(food);
+        std::string name;
+        size_t matched = 0;
+        FoodLink* prev = nullptr;
+        for (FoodLink* link = node->foods; link != nullptr; link = link->next) {
+            lowerInto(name, link->food->name);
+            if (name != key) {
+                prev = link;
+            } else if (matched++ == 0) {
+                link->food = record;
+                prev = link;
+            } else {
+                unlink(node, prev, link);
+            }
+        }
+        if (matched == 0) insertBelow(node, key, key.size(), *record, storage[0], false);
+        return matched;
+    }
+
+    // Remove every food whose name equals `foodName` ignoring case;
+    // returns how many were removed
+    size_t remove(const std::string& foodName) {
+        std::string key = toLower(foodName);
+        TrieNode* node = root;
+        for (char c : key) {
+            node = node->children[TrieNode::charToIndex(c)];
+            if (node == nullptr) return 0;
+        }
+
+        std::string name;
+        size_t removed = 0;
+        FoodLink* prev = nullptr;
+        for (FoodLink* link = node->foods; link != nullptr; link = link->next) {
+            lowerInto(name, link->food->name);
+            if (name == key) {
+                unlink(node, prev, link);
+                removed++;
+            } else {
+                prev = link;
+            }
+        }
+        if (node->foods == nullptr) node->isEndOfWord = false;
+        return removed;
     }
 
     // Search for exact match
     std::vector<Food> searchExact(const std::string& name) const {
         std::string key = toLower(name);
-        TrieNode* current = root.get();
+        TrieNode* current = root;
 
         for (char c : key) {
             int index = TrieNode::charToIndex(c);
             if (current->children[index] == nullptr) {
                 return std::vector<Food>(); // Not found
             }
-            current = current->children[index].get();
+            current = current->children[index];
         }
 
         if (current != nullptr && current->isEndOfWord) {
-            return current->foods;
+            return copyFoods(current);
         }
         return std::vector<Food>();
     }
 
+    // Exact match for many names at once. Queries are sorted so neighbours
+    // share prefixes; the path walked for the previous query is kept and the
+    // next one only descends from where the two keys diverge.
+    // Results come back in the same order as the input.
+    std::vector<std::vector<Food>> searchExactBatch(const std::vector<std::string>& names) const {
+        std::vector<std::vector<Food>> results(names.size());
+
+        std::vector<std::string> keys(names.size());
+        for (size_t i = 0; i < names.size(); i++) {
+            keys[i] = toLower(names[i]);
+        }
+        std::vector<size_t> order(names.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+        // path[k] is the node reached after the first k characters of prev
+        std::vector<const TrieNode*> path(1, root);
+        const std::string* prev = nullptr;
+        size_t prevOwner = 0;
+
+        for (size_t i : order) {
+            const std::string& key = keys[i];
+            if (prev != nullptr && *prev == key) {
+                results[i] = results[prevOwner];
+                continue;
+            }
+
+            size_t shared = 0;
+            if (prev != nullptr) {
+                size_t limit = std::min(prev->size(), key.size());
+                while (shared < limit && (*prev)[shared] == key[shared]) shared++;
+            }
+            if (path.size() > shared + 1) path.resize(shared + 1);
+
+            const TrieNode* current = path.back();
+            for (size_t k = path.size() - 1; k < key.size(); k++) {
+                int index = TrieNode::charToIndex(key[k]);
+                current = current->children[index];
+                if (current == nullptr) break;
+                path.push_back(current);
+            }
+
+            if (current != nullptr && current->isEndOfWord) {
+                results[i] = copyFoods(current);
+            }
+            prev = &key;
+            prevOwner = i;
+        }
+        return results;
+    }
+
     // Search for prefix matches (efficient in Trie!)
     std::vector<Food> searchPrefix(const std::string& prefix) const {
         std::vector<Food> results;
         std::string key = toLower(prefix);
-        TrieNode* current = root.get();
+        TrieNode* current = root;
 
         // Navigate to the prefix node
         for (char c : key) {
@@ -113,7 +395,7 @@ public:
             if (current->children[index] == nullptr) {
                 return results; // Prefix not found
             }
-            current = current->children[index].get();
+            current = current->children[index];
         }
 
         // Collect all foods from this node and its descendants
@@ -121,6 +403,42 @@ public:
         return results;
     }
 
+    // The search overloads taking an output vector append pointers to the
+    // stored foods instead of copying them, so callers can reuse the buffer
+    void searchExact(const std::string& name, std::vector<const Food*>& out) const {
+        const TrieNode* node = findNode(toLower(name));
+        if (node != nullptr && node->isEndOfWord) {
+            for (const FoodLink* link = node->foods; link != nullptr; link = link->next) {
+                out.push_back(link->food);
+            }
+        }
+    }
+
+    void searchPrefix(const std::string& prefix, std::vector<const Food*>& out) const {
+        const TrieNode* node = findNode(toLower(prefix));
+        if (node != nullptr) collectAllFoods(node, out);
+    }
+
+    void searchContains(const std::string& searchTerm, std::vector<const Food*>& out) const {
+        std::string lowerTerm = toLower(searchTerm);
+        std::vector<const Food*> allFoods;
+        collectAllFoods(root, allFoods);
+        for (const Food* food : allFoods) {
+            if (toLower(food->name).find(lowerTerm) != std::string::npos) {
+                out.push_back(food);
+            }
+        }
+    }
+
+    // Up to `limit` distinct names starting with prefix, for autocomplete.
+    // Unlike searchPrefix this never copies more than `limit` entries.
+    std::vector<std::string> completeNames(const std::string& prefix, size_t limit) const {
+        std::vector<std::string> names;
+        const TrieNode* node = findNode(toLower(prefix));
+        if (node != nullptr) collectNames(node, limit, names);
+        return names;
+    }
+
     // Search for foods containing the search term anywhere in the name
     // Note: This is not efficient in a Trie (same as HashMap)
     // We'll need to traverse the entire tree
@@ -130,7 +448,7 @@ public:
         
         // Get all foods and filter
         std::vector<Food> allFoods;
-        collectAllFoods(root.get(), allFoods);
+        collectAllFoods(root, allFoods);
         
         for (const auto& food : allFoods) {
             std::string lowerName = toLower(food.name);
@@ -149,16 +467,25 @@ public:
         int count = 1;
         for (int i = 0; i < TrieNode::ALPHABET_SIZE; i++) {
             if (node->children[i] != nullptr) {
-                count += countNodes(node->children[i].get());
+                count += countNodes(node->children[i]);
             }
         }
         return count;
     }
 
     void printStats() const {
-        int totalNodes = countNodes(root.get());
+        int totalNodes = countNodes(root);
         std::cout << "\n=== Trie Statistics ===" << std::endl;
         std::cout << "Total Nodes: " << totalNodes << std::endl;
+        size_t arenaBytes = 0, arenaBlocks = 0, recordBytes = 0;
+        for (const auto& part : storage) {
+            arenaBytes += part.nodes.bytesUsed();
+            arenaBlocks += part.nodes.blockCount();
+            recordBytes += part.records.bytesReserved();
+        }
+        std::cout << "Arena: " << arenaBytes / 1024 << " KiB in "
+                  << arenaBlocks << " block(s), records "
+                  << recordBytes / 1024 << " KiB" << std::endl;
     }
 };
 
@@ -5,61 +5,169 @@
 #include <vector>
 #include <string>
 #include <limits>
+#include <fstream>
 #include "Food.h"
 #include "HashMap.h"
 #include "Trie.h"
 #include "CSVReader.h"
+#include "BatchRunner.h"
+#include "QueryService.h"
+#include "BackgroundLoader.h"
+#include "DataSnapshot.h"
+#include "Snapshot.h"
+#include "FileWatcher.h"
+#include "Delta.h"
+#include "Meal.h"
+#include "MealStore.h"
+#include "MealLogScorer.h"
+#include "MealOptimizer.h"
+#include "NutrientIndex.h"
+#include "DayPlanner.h"
+#include "ScoreIndex.h"
+#include "BrandIndex.h"
+#include "DuplicateIndex.h"
+#include "NameDictionary.h"
+#include "AdaptiveRadixTree.h"
+#include "DatasetAnalytics.h"
+#include "CompactNutrients.h"
+#include "LazyIndex.h"
+#include <atomic>
+#include <csignal>
+#include <thread>
 
 using namespace std;
 using namespace chrono;
 
-struct SavedMeal {
-    long long id;
-    string name;
-    int score;
-    string feedback;
-    vector<Food> items;
-    Food total;
-};
+#ifndef MEAL_DEFAULT_DATA_PATH
+#define MEAL_DEFAULT_DATA_PATH "../../web/data/nutrition_100k_branded.csv"
+#endif
+
+#ifndef MEAL_DEFAULT_HISTORY_PATH
+#define MEAL_DEFAULT_HISTORY_PATH "meal_history.log"
+#endif
 
 class MealQualityScorer {
     HashMap hashMap;
     Trie trie;
-    vector<Food> mealItems;
-    vector<SavedMeal> mealHistory;
-    Food mealTotal;
+    FoodTable mealFoods; // foods of the current meal; emptied with it
+    Meal meal{mealFoods};
+    MealStore history;
+    long long optimizeBudgetMs = MealOptimizer::Settings().budgetMs;
+    // Indexes over the loaded foods, built on first use; applying a delta
+    // bumps the version so each is rebuilt on its next use
+    uint64_t dataVersion = 0;
+    LazyIndex<NutrientIndex> nutrients{dataVersion};
+    LazyIndex<ScoreIndex> scores{dataVersion};
+    LazyIndex<BrandIndex> brands{dataVersion};
+    LazyIndex<DuplicateIndex> duplicates{dataVersion};
+    LazyIndex<NameDictionary> dictionary{dataVersion};
+    LazyIndex<AdaptiveRadixTree> radixTree{dataVersion};
+    LazyIndex<DatasetAnalytics> analytics{dataVersion};
+    bool compactNutrients = false; // opt-in 16-bit nutrient columns
+    LazyIndex<CompactNutrients> compact{dataVersion};
+    LoadStats loadStats;
+    BackgroundLoader loader{hashMap, trie}; // declared after the indexes it fills
+
+    // Saved meals listed by View Meal History, most recent first
+    static const size_t HISTORY_SHOWN = 20;
+
+    // Timed repetitions behind each interactive search comparison
+    static const int TIMING_RUNS = 7;
+
+    // Run `search` once to warm up, then TIMING_RUNS more times, and return
+    // the median duration; a single sample is too noisy to compare
+    template <typename Fn>
+    static long long medianMicros(Fn search) {
+        search();
+        vector<long long> samples;
+        for (int i = 0; i < TIMING_RUNS; i++) {
+            auto start = high_resolution_clock::now();
+            search();
+            samples.push_back(duration_cast<microseconds>(high_resolution_clock::now() - start).count());
+        }
+        nth_element(samples.begin(), samples.begin() + TIMING_RUNS / 2, samples.end());
+        return samples[TIMING_RUNS / 2];
+    }
+
 public:
-    void loadData(const string& filename) {
+    // Keep the nutrients as 16-bit fixed point too, verified against the
+    // double scores once the data is loaded
+    void useCompactNutrients() { compactNutrients = true; }
+
+    // Copy the loader's timings once every stage has finished
+    void recordLoadStats() {
+        loadStats.foods = loader.rowsParsed();
+        loadStats.hashMapBuildMs = loader.millis(BackgroundLoader::HASHMAP_READY);
+        loadStats.trieBuildMs = loader.millis(BackgroundLoader::TRIE_READY);
+        loadStats.indexBuildMs = loader.indexMillis();
+    }
+
+    // Progress line rewritten in place while a command waits for the loader
+    void showProgress() {
+        cout << "\r" << loader.status() << "        " << flush;
+    }
+
+    // Start the background load; the brand index is built as its last
+    // stage, so brand queries find it ready
+    void startLoading(const string& filename, const vector<string>& deltas) {
+        loader.derive([this]() { brands.refresh([this](BrandIndex& index) { index.build(hashMap); }); });
+        loader.start(filename, deltas);
+    }
+
+    // Block until every loader stage is done, showing progress meanwhile
+    bool waitForIndexes() {
+        if (loader.isDone()) return true;
+        cout << "\nWaiting for the indexes to finish building..." << endl;
+        auto progress = [this]() { showProgress(); };
+        bool ok = loader.waitFor(BackgroundLoader::HASHMAP_READY, progress) &&
+                  loader.waitFor(BackgroundLoader::TRIE_READY, progress) &&
+                  loader.waitFor(BackgroundLoader::DERIVED_READY, progress);
+        cout << "\r" << loader.status() << "        " << endl;
+        if (!ok) {
+            cout << "Error: No data loaded!" << endl;
+            return false;
+        }
+        recordLoadStats();
+        return true;
+    }
+
+    // Load synchronously (batch and server modes): the same stages as the
+    // background load, waited for one after another
+    bool loadData(const string& filename, const vector<string>& deltas) {
         cout << "\n========================================" << endl;
         cout << "   MEAL QUALITY SCORER - DATA LOADING" << endl;
         cout << "========================================\n" << endl;
 
-        vector<Food> foods = CSVReader::loadFromCSV(filename);
-
-        if (foods.empty()) {
+        cout << "Loading data from " << filename << "..." << endl;
+        startLoading(filename, deltas);
+        if (!loader.waitFor(BackgroundLoader::PARSED)) {
             cout << "Error: No data loaded!" << endl;
-            return;
+            return false;
         }
-        cout << "\nLoading into HashMap..." << endl;
-        auto start = high_resolution_clock::now();
-        for (const auto& food : foods) {
-            hashMap.insert(food);
+        cout << "Loaded " << loader.rowsParsed() << " food items in "
+             << loader.millis(BackgroundLoader::PARSED) << " ms." << endl;
+        if (!deltas.empty()) {
+            cout << "Applying " << deltas.size() << " delta file(s) after the build." << endl;
         }
-        auto end = high_resolution_clock::now();
-        auto hashMapTime = duration_cast<milliseconds>(end - start).count();
-        cout << "HashMap build time: " << hashMapTime << " ms" << endl;
 
-        cout << "\nLoading into Trie..." << endl;
-        start = high_resolution_clock::now();
-        for (const auto& food : foods) {
-            trie.insert(food);
-        }
-        end = high_resolution_clock::now();
-        auto trieTime = duration_cast<milliseconds>(end - start).count();
-        cout << "Trie build time: " << trieTime << " ms" << endl;
+        // Both indexes are built at once and share the cores
+        cout << "\nBuilding HashMap (" << loader.threadsFor(BackgroundLoader::HASHMAP_READY)
+             << " thread(s)) and Trie (" << loader.threadsFor(BackgroundLoader::TRIE_READY)
+             << " thread(s)) in parallel..." << endl;
+        loader.waitFor(BackgroundLoader::HASHMAP_READY);
+        loader.waitFor(BackgroundLoader::TRIE_READY);
+        loader.waitFor(BackgroundLoader::DERIVED_READY);
+        recordLoadStats();
+
+        cout << "HashMap build time: " << loadStats.hashMapBuildMs << " ms" << endl;
+        cout << "Trie build time: " << loadStats.trieBuildMs << " ms" << endl;
+        cout << "Total index build time: " << loadStats.indexBuildMs << " ms" << endl;
+        cout << "Brand index build time: " << loader.millis(BackgroundLoader::DERIVED_READY) << " ms" << endl;
+        if (compactNutrients) refreshCompactNutrients();
 
         cout << "\nData loaded successfully!" << endl;
         cout << "========================================\n" << endl;
+        return true;
     }
 
     void displayResults(const vector<Food>& results, int maxDisplay = 10) {
@@ -84,6 +192,146 @@ public:
         }
     }
 
+    void displayResults(const vector<const Food*>& results, int maxDisplay = 10) {
+        vector<Food> foods;
+        foods.reserve(results.size());
+        for (const Food* food : results) foods.push_back(*food);
+        displayResults(foods, maxDisplay);
+    }
+
+    // Group the foods by score for "healthiest matches", unless already done
+    // for the current data
+    void refreshScoreIndex() {
+        scores.refresh([&](ScoreIndex& index) {
+            auto start = high_resolution_clock::now();
+            index.build(hashMap);
+            cout << "Score index: " << index.size() << " foods grouped by score in "
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - start).count() << " ms" << endl;
+        });
+    }
+
+    // The N best-scoring foods whose name contains a term: the score index
+    // against scoring and sorting every contains match
+    void searchHealthiest(const string& searchTerm) {
+        cout << "How many results (default 10)? ";
+        size_t count;
+        cin >> count;
+        if (count == 0) count = 10;
+        refreshScoreIndex();
+
+        ScoreIndex::Filter filter;
+        filter.contains = searchTerm;
+        vector<const Food*> ranked;
+        size_t scanned = 0;
+        long long indexTime = medianMicros([&]() {
+            ranked.clear();
+            scanned = scores->topByScore(filter, count, ranked);
+        });
+
+        vector<Food> sorted;
+        long long sortTime = medianMicros([&]() {
+            sorted = hashMap.searchContains(searchTerm);
+            stable_sort(sorted.begin(), sorted.end(), [](const Food& a, const Food& b) {
+                return a.calculateScore() > b.calculateScore();
+            });
+        });
+
+        if (ranked.empty()) {
+            cout << "\nNo foods found matching '" << searchTerm << "'" << endl;
+        } else {
+            cout << "\nThe " << ranked.size() << " best-scoring foods matching '" << searchTerm << "':\n" << endl;
+        }
+        for (size_t i = 0; i < ranked.size(); i++) {
+            cout << (i + 1) << ". " << ranked[i]->name << endl;
+            cout << "   Score: " << ranked[i]->calculateScore() << "/10 - " << ranked[i]->getFeedback() << endl;
+        }
+        cout << "\nScore index: " << indexTime << " microseconds, " << scanned << " of " << scores->size()
+             << " foods looked at (median of " << TIMING_RUNS << " runs)" << endl;
+        cout << "Contains search + sort of all " << sorted.size() << " matches: " << sortTime
+             << " microseconds" << endl;
+    }
+
+    // Sort and front-code the distinct names, unless already done for the
+    // current data
+    void refreshNameDictionary() {
+        dictionary.refresh([&](NameDictionary& index) {
+            auto start = high_resolution_clock::now();
+            index.build(hashMap);
+            cout << "Name dictionary: " << index.names() << " distinct names front coded in "
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - start).count() << " ms" << endl;
+        });
+    }
+
+    // Insert the distinct names into the adaptive radix tree, unless already
+    // done for the current data
+    void refreshRadixTree() {
+        radixTree.refresh([&](AdaptiveRadixTree& index) {
+            auto start = high_resolution_clock::now();
+            index.build(hashMap);
+            cout << "Adaptive radix tree: " << index.names() << " distinct names inserted in "
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - start).count() << " ms" << endl;
+        });
+    }
+
+    // Group the foods by brand, unless already done for the current data
+    void refreshBrandIndex() {
+        brands.refresh([&](BrandIndex& index) {
+            auto start = high_resolution_clock::now();
+            index.build(hashMap);
+            cout << "Brand index: " << index.size() << " foods under " << index.brandCount() << " brands in "
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - start).count() << " ms" << endl;
+        });
+    }
+
+    // A brand's foods scoring at least N: the brand index against a prefix
+    // scan that scores and sorts every match
+    void searchBrand(const string& brand) {
+        cout << "Minimum score (1-10): ";
+        int minScore;
+        cin >> minScore;
+        refreshBrandIndex();
+
+        vector<BrandIndex::Brand> similar;
+        brands->brandsStartingWith(brand, 5, similar);
+        vector<const Food*> ranked;
+        size_t matching = 0;
+        long long indexTime = medianMicros([&]() {
+            ranked.clear();
+            matching = brands->fromBrand(brand, minScore, 10, ranked);
+        });
+
+        vector<Food> scanned;
+        long long scanTime = medianMicros([&]() {
+            scanned = hashMap.searchPrefix(brand);
+            scanned.erase(remove_if(scanned.begin(), scanned.end(),
+                                    [minScore](const Food& food) { return food.calculateScore() < minScore; }),
+                          scanned.end());
+            stable_sort(scanned.begin(), scanned.end(), [](const Food& a, const Food& b) {
+                return a.calculateScore() > b.calculateScore();
+            });
+        });
+
+        if (ranked.empty()) {
+            cout << "\nNo foods from '" << brand << "' score " << minScore << " or more" << endl;
+            if (!similar.empty()) {
+                cout << "Brands starting with '" << brand << "':";
+                for (const auto& found : similar) cout << " " << found.name << " (" << found.foods << ")";
+                cout << endl;
+            }
+        } else {
+            cout << "\n" << matching << " foods from '" << brand << "' score " << minScore << " or more";
+            if (matching > ranked.size()) cout << " (showing the best " << ranked.size() << ")";
+            cout << ":\n" << endl;
+        }
+        for (size_t i = 0; i < ranked.size(); i++) {
+            cout << (i + 1) << ". " << ranked[i]->name << endl;
+            cout << "   Score: " << ranked[i]->calculateScore() << "/10 - " << ranked[i]->getFeedback() << endl;
+        }
+        cout << "\nBrand index: " << indexTime << " microseconds (median of " << TIMING_RUNS << " runs)" << endl;
+        cout << "HashMap prefix scan + score filter + sort (" << scanned.size() << " matches): " << scanTime
+             << " microseconds" << endl;
+    }
+
     void searchFood() {
         cout << "\n========================================" << endl;
         cout << "         SEARCH FOR FOOD ITEMS" << endl;
@@ -103,51 +351,151 @@ public:
         cout << "1. Exact match" << endl;
         cout << "2. Prefix search (starts with)" << endl;
         cout << "3. Contains search" << endl;
+        cout << "4. Healthiest matches (top N by score)" << endl;
+        cout << "5. Brand (foods from a brand above a score)" << endl;
         cout << "Choice: ";
 
         int choice;
         cin >> choice;
-
-        vector<Food> hashMapResults, trieResults;
-        auto hashMapTime = 0LL, trieTime = 0LL;
-
-        auto start = high_resolution_clock::now();
-        if (choice == 1) {
-            hashMapResults = hashMap.searchExact(searchTerm);
-        } else if (choice == 2) {
-            hashMapResults = hashMap.searchPrefix(searchTerm);
-        } else if (choice == 3) {
-            hashMapResults = hashMap.searchContains(searchTerm);
+        if (!waitForIndexes()) return;
+        if (choice == 4) {
+            searchHealthiest(searchTerm);
+            return;
         }
-        auto end = high_resolution_clock::now();
-        hashMapTime = duration_cast<microseconds>(end - start).count();
-
-        start = high_resolution_clock::now();
-        if (choice == 1) {
-            trieResults = trie.searchExact(searchTerm);
-        } else if (choice == 2) {
-            trieResults = trie.searchPrefix(searchTerm);
-        } else if (choice == 3) {
-            trieResults = trie.searchContains(searchTerm);
+        if (choice == 5) {
+            searchBrand(searchTerm);
+            return;
         }
-        end = high_resolution_clock::now();
-        trieTime = duration_cast<microseconds>(end - start).count();
+
+        // Every structure is timed through its pointer overloads, so no
+        // timing includes copying the matches out
+        auto timeSearch = [&](const auto& index, vector<const Food*>& results) {
+            return medianMicros([&]() {
+                results.clear();
+                if (choice == 1) {
+                    index.searchExact(searchTerm, results);
+                } else if (choice == 2) {
+                    index.searchPrefix(searchTerm, results);
+                } else if (choice == 3) {
+                    index.searchContains(searchTerm, results);
+                }
+            });
+        };
+        vector<const Food*> hashMapResults, trieResults, dictionaryResults, radixTreeResults;
+        long long hashMapTime = timeSearch(hashMap, hashMapResults);
+        long long trieTime = timeSearch(trie, trieResults);
+        refreshNameDictionary();
+        long long dictionaryTime = timeSearch(*dictionary, dictionaryResults);
+        refreshRadixTree();
+        long long radixTreeTime = timeSearch(*radixTree, radixTreeResults);
 
         cout << "\n--- HashMap Results ---" << endl;
         displayResults(hashMapResults);
-        cout << "Search time: " << hashMapTime << " microseconds" << endl;
+        cout << "Search time: " << hashMapTime << " microseconds (median of "
+             << TIMING_RUNS << " runs)" << endl;
 
         cout << "\n--- Trie Results ---" << endl;
         displayResults(trieResults);
-        cout << "Search time: " << trieTime << " microseconds" << endl;
+        cout << "Search time: " << trieTime << " microseconds (median of "
+             << TIMING_RUNS << " runs)" << endl;
+
+        cout << "\n--- Name Dictionary ---" << endl;
+        cout << dictionaryResults.size() << " results in " << dictionaryTime << " microseconds (median of "
+             << TIMING_RUNS << " runs)" << endl;
 
+        cout << "\n--- Adaptive Radix Tree ---" << endl;
+        cout << radixTreeResults.size() << " results in " << radixTreeTime << " microseconds (median of "
+             << TIMING_RUNS << " runs)" << endl;
+
+        // Fastest first; ties keep the order above
+        using Timing = pair<string, long long>;
+        vector<Timing> times = {{"HashMap", hashMapTime},
+                                {"Trie", trieTime},
+                                {"Name Dictionary", dictionaryTime},
+                                {"Adaptive Radix Tree", radixTreeTime}};
+        stable_sort(times.begin(), times.end(), [](const Timing& a, const Timing& b) { return a.second < b.second; });
         cout << "\n--- Performance Comparison ---" << endl;
-        if (trieTime < hashMapTime) {
-            cout << "Trie was faster by " << (hashMapTime - trieTime) << " microseconds" << endl;
-        } else if (hashMapTime < trieTime) {
-            cout << "HashMap was faster by " << (trieTime - hashMapTime) << " microseconds" << endl;
+        if (times.back().second == times.front().second) {
+            cout << "All performed equally!" << endl;
         } else {
-            cout << "Both performed equally!" << endl;
+            cout << times[0].first << " was fastest (" << times[0].second << " microseconds)" << endl;
+            for (size_t i = 1; i < times.size(); i++) {
+                cout << "  " << times[i].first << ": " << (times[i].second - times[0].second)
+                     << " microseconds slower" << endl;
+            }
+        }
+        cout << "(Run MealBench for full latency distributions across query mixes.)" << endl;
+    }
+
+    void batchSearch() {
+        cout << "\n========================================" << endl;
+        cout << "       BATCH EXACT SEARCH (FROM FILE)" << endl;
+        cout << "========================================\n" << endl;
+
+        cout << "Enter path to a file with one food name per line: ";
+        string path;
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        getline(cin, path);
+
+        ifstream file(path);
+        if (!file.is_open()) {
+            cout << "Error: Could not open file " << path << endl;
+            return;
+        }
+        vector<string> queries;
+        string line;
+        while (getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) queries.push_back(line);
+        }
+        if (queries.empty()) {
+            cout << "No queries found in " << path << endl;
+            return;
+        }
+        if (!waitForIndexes()) return;
+
+        size_t hits = 0;
+        auto start = high_resolution_clock::now();
+        for (const auto& q : queries) {
+            hits += hashMap.searchExact(q).empty() ? 0 : 1;
+        }
+        auto hashMapSingle = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        vector<vector<Food>> hashMapBatch = hashMap.searchExactBatch(queries);
+        auto hashMapBatchTime = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        for (const auto& q : queries) {
+            trie.searchExact(q);
+        }
+        auto trieSingle = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        vector<vector<Food>> trieBatch = trie.searchExactBatch(queries);
+        auto trieBatchTime = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+        cout << "\nQueries: " << queries.size() << " (" << hits << " with matches)" << endl;
+        cout << "\n--- Throughput (queries/second) ---" << endl;
+        cout << fixed << setprecision(0);
+        auto qps = [&queries](long long micros) {
+            return micros > 0 ? queries.size() * 1e6 / micros : 0.0;
+        };
+        cout << "HashMap one-at-a-time: " << qps(hashMapSingle) << " (" << hashMapSingle << " microseconds)" << endl;
+        cout << "HashMap batched:       " << qps(hashMapBatchTime) << " (" << hashMapBatchTime << " microseconds)" << endl;
+        cout << "Trie one-at-a-time:    " << qps(trieSingle) << " (" << trieSingle << " microseconds)" << endl;
+        cout << "Trie batched:          " << qps(trieBatchTime) << " (" << trieBatchTime << " microseconds)" << endl;
+
+        cout << "\n--- First results ---" << endl;
+        size_t shown = min<size_t>(10, queries.size());
+        for (size_t i = 0; i < shown; i++) {
+            cout << (i + 1) << ". " << queries[i] << ": "
+                 << hashMapBatch[i].size() << " match(es) in HashMap, "
+                 << trieBatch[i].size() << " in Trie";
+            if (!hashMapBatch[i].empty()) {
+                cout << ", score " << hashMapBatch[i][0].calculateScore() << "/10";
+            }
+            cout << endl;
         }
     }
 
@@ -161,7 +509,17 @@ public:
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         getline(cin, searchTerm);
 
-        vector<Food> results = hashMap.searchContains(searchTerm);
+        // Pointers into the index; while it is still building, into copies
+        // of the matches among the rows parsed so far
+        vector<const Food*> results;
+        vector<Food> parsedMatches;
+        if (loader.isReady(BackgroundLoader::HASHMAP_READY)) {
+            hashMap.searchContains(searchTerm, results);
+        } else if (searchParsedRows(searchTerm, parsedMatches)) {
+            for (const auto& food : parsedMatches) results.push_back(&food);
+        } else {
+            return;
+        }
 
         if (results.empty()) {
             cout << "No foods found matching '" << searchTerm << "'" << endl;
@@ -171,7 +529,7 @@ public:
         cout << "\nSelect a food:" << endl;
         int maxDisplay = min(20, (int)results.size());
         for (int i = 0; i < maxDisplay; i++) {
-            cout << (i + 1) << ". " << results[i].name << endl;
+            cout << (i + 1) << ". " << results[i]->name << endl;
         }
 
         cout << "\nEnter number (0 to cancel): ";
@@ -183,7 +541,7 @@ public:
             return;
         }
 
-        Food selectedFood = results[choice - 1];
+        const Food& selectedFood = *results[choice - 1];
 
         cout << "Enter serving size in grams (default 100g): ";
         double servingSize;
@@ -191,26 +549,36 @@ public:
 
         if (servingSize <= 0) servingSize = 100;
 
-        double multiplier = servingSize / 100.0;
-        Food adjustedFood = selectedFood;
-        adjustedFood.kcal *= multiplier;
-        adjustedFood.protein *= multiplier;
-        adjustedFood.fat *= multiplier;
-        adjustedFood.carbs *= multiplier;
-        adjustedFood.sugar *= multiplier;
-        adjustedFood.fiber *= multiplier;
-        adjustedFood.satfat *= multiplier;
-        adjustedFood.sodium *= multiplier;
-
-        mealItems.push_back(adjustedFood);
-        mealTotal.name = "";
+        meal.add(selectedFood, servingSize);
 
         cout << "\nAdded to meal: " << selectedFood.name
              << " (" << servingSize << "g)" << endl;
     }
 
+    // Contains search over the rows parsed so far, while the HashMap is
+    // still building. Returns false if there is no data to search.
+    bool searchParsedRows(const string& searchTerm, vector<Food>& results) {
+        if (loader.hasFailed()) {
+            cout << "Error: No data loaded!" << endl;
+            return false;
+        }
+        string lowerTerm = searchTerm;
+        transform(lowerTerm.begin(), lowerTerm.end(), lowerTerm.begin(),
+                  [](unsigned char c) { return tolower(c); });
+        size_t scanned = 0;
+        loader.scanParsed([&](const Food& food) {
+            scanned++;
+            auto it = search(food.name.begin(), food.name.end(), lowerTerm.begin(), lowerTerm.end(),
+                             [](char a, char b) { return tolower(static_cast<unsigned char>(a)) == b; });
+            if (it != food.name.end() || lowerTerm.empty()) results.push_back(food);
+        });
+        cout << "(Still loading: searched the " << scanned << " rows parsed so far - "
+             << loader.status() << ")" << endl;
+        return true;
+    }
+
     void calculateMealScore() {
-        if (mealItems.empty()) {
+        if (meal.empty()) {
             cout << "\nNo items in meal! Add some foods first." << endl;
             return;
         }
@@ -219,23 +587,12 @@ public:
         cout << "         YOUR MEAL SCORE" << endl;
         cout << "========================================\n" << endl;
 
-        mealTotal = Food();
-        mealTotal.name = "Your Complete Meal";
-
-        for (const auto& food : mealItems) {
-            mealTotal.kcal += food.kcal;
-            mealTotal.protein += food.protein;
-            mealTotal.fat += food.fat;
-            mealTotal.carbs += food.carbs;
-            mealTotal.sugar += food.sugar;
-            mealTotal.fiber += food.fiber;
-            mealTotal.satfat += food.satfat;
-            mealTotal.sodium += food.sodium;
-        }
+        // Kept up to date as items are added, so this is not a rescan
+        Food mealTotal = meal.total("Your Complete Meal");
 
         cout << "Meal Contents:" << endl;
-        for (size_t i = 0; i < mealItems.size(); i++) {
-            cout << (i + 1) << ". " << mealItems[i].name << endl;
+        for (size_t i = 0; i < meal.size(); i++) {
+            cout << (i + 1) << ". " << meal.name(i) << " (" << meal.items()[i].grams << "g)" << endl;
         }
 
         mealTotal.display();
@@ -248,56 +605,169 @@ public:
         cout << "========================================\n" << endl;
     }
 
+    // Search for swaps and serving changes that raise the meal's score and
+    // offer to apply the best of them
+    void optimizeMeal() {
+        if (meal.empty()) {
+            cout << "\nNo items in meal! Add some foods first." << endl;
+            return;
+        }
+        if (!waitForIndexes()) return;
+
+        cout << "\n========================================" << endl;
+        cout << "         MEAL OPTIMIZER" << endl;
+        cout << "========================================\n" << endl;
+
+        vector<MealOptimizer::Item> items;
+        for (const auto& item : meal.items()) items.push_back({mealFoods.get(item.food), item.grams});
+
+        MealOptimizer::Settings settings;
+        settings.budgetMs = optimizeBudgetMs;
+        MealOptimizer optimizer;
+        MealOptimizer::Result result = optimizer.optimize(hashMap, items, settings);
+
+        cout << "Current score: " << result.baseline << "/10" << endl;
+        cout << "Searched " << result.nodes << " partial plans in " << result.searchMs << " ms"
+             << (result.complete ? " (exhaustive)" : " (time budget reached)") << ", substitutes found in "
+             << result.candidateMs << " ms" << endl;
+        if (result.plans.empty()) {
+            cout << "\nNo swaps or serving changes raise this meal's score." << endl;
+            return;
+        }
+
+        for (size_t p = 0; p < result.plans.size(); p++) {
+            const MealOptimizer::Plan& plan = result.plans[p];
+            cout << "\nPlan " << (p + 1) << ": " << result.baseline << "/10 -> " << plan.score << "/10 ("
+                 << plan.changes << " change(s))" << endl;
+            for (size_t i = 0; i < items.size(); i++) {
+                const MealOptimizer::Item& before = items[i];
+                const MealOptimizer::Item& after = plan.items[i];
+                if (after.food.name != before.food.name) {
+                    cout << "  - Swap " << before.food.name << " (" << before.grams << "g) for "
+                         << after.food.name << " (" << after.grams << "g)" << endl;
+                } else if (after.grams != before.grams) {
+                    cout << "  - " << (after.grams < before.grams ? "Cut " : "Raise ") << before.food.name
+                         << " to " << after.grams << "g" << endl;
+                }
+            }
+        }
+
+        cout << "\nApply a plan? (number, 0 to keep the meal): ";
+        size_t choice;
+        cin >> choice;
+        if (choice < 1 || choice > result.plans.size()) {
+            cout << "Meal unchanged." << endl;
+            return;
+        }
+        meal.clear();
+        for (const auto& item : result.plans[choice - 1].items) meal.add(item.food, item.grams);
+        cout << "\nPlan " << choice << " applied: the meal now scores " << meal.score() << "/10." << endl;
+    }
+
+    // Sort the foods by nutrient for the day planner, unless already done
+    // for the current data
+    void refreshNutrientIndex() {
+        nutrients.refresh([&](NutrientIndex& index) {
+            auto start = high_resolution_clock::now();
+            index.build(hashMap);
+            cout << "Nutrient index: " << index.size() << " foods sorted by each nutrient in "
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - start).count() << " ms" << endl;
+        });
+    }
+
+    void printDayPlan(const DayPlanner::Plan& plan, const DayPlanner::Targets& targets) {
+        if (plan.meals.empty()) {
+            cout << "No foods qualify for a plan (" << plan.poolSize << " in the pool)." << endl;
+            return;
+        }
+        cout << fixed << setprecision(0);
+        for (size_t s = 0; s < DayPlanner::SLOT_COUNT; s++) {
+            const DayPlanner::PlannedMeal& planned = plan.meals[s];
+            cout << "\n" << DayPlanner::SLOTS[s].name << " (" << planned.total.kcal << " kcal, score "
+                 << planned.score << "/10)" << endl;
+            for (const auto& item : planned.items) {
+                cout << "  - " << item.food->name << " (" << item.grams << "g)" << endl;
+            }
+        }
+        cout << "\nDay: " << plan.total.kcal << "/" << targets.kcal << " kcal, protein " << plan.total.protein
+             << "/" << targets.protein() << "g, fat " << plan.total.fat << "/" << targets.fat() << "g, carbs "
+             << plan.total.carbs << "/" << targets.carbs() << "g" << endl;
+        cout << "Summed score: " << plan.score << "/" << DayPlanner::SLOT_COUNT * 10
+             << (plan.onTarget ? " (all targets within " : " (some targets missed by more than ")
+             << targets.tolerance * 100 << "%)" << endl;
+        cout << "Planned from " << plan.poolSize << " candidate foods in " << plan.millis << " ms" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+
+    // Generate a day of meals for an energy target
+    void planDay() {
+        if (!waitForIndexes()) return;
+
+        cout << "\n========================================" << endl;
+        cout << "         DAY PLANNER" << endl;
+        cout << "========================================\n" << endl;
+
+        DayPlanner::Targets targets;
+        DayPlanner::Settings settings;
+        cout << "Daily energy target in kcal (default " << targets.kcal << "): ";
+        double kcal;
+        cin >> kcal;
+        if (kcal > 0) targets.kcal = kcal;
+        cout << "Seed (same seed, same plan; default " << settings.seed << "): ";
+        long long seed;
+        cin >> seed;
+        if (seed > 0) settings.seed = static_cast<unsigned long long>(seed);
+
+        refreshNutrientIndex();
+        DayPlanner planner(*nutrients);
+        printDayPlan(planner.plan(targets, settings), targets);
+    }
+
     void clearMeal() {
-        mealItems.clear();
-        mealTotal = Food();
+        meal.clear();
         cout << "\nMeal cleared!" << endl;
     }
 
     void saveCurrentMeal() {
-        if (mealItems.empty()) {
+        if (meal.empty()) {
             cout << "\nCannot save an empty meal. Add some items first." << endl;
             return;
         }
-        if (mealTotal.name.empty()) {
-            cout << "\nCalculate the score first before saving." << endl;
-            calculateMealScore();
-        }
-
         cout << "\nEnter a name for this meal: ";
         string mealName;
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         getline(cin, mealName);
 
-        SavedMeal newMeal;
-        newMeal.id = high_resolution_clock::now().time_since_epoch().count();
-        newMeal.name = mealName;
-        newMeal.items = mealItems;
-        newMeal.total = mealTotal;
-        newMeal.score = mealTotal.calculateScore();
-        newMeal.feedback = mealTotal.getFeedback();
-
-        mealHistory.push_back(newMeal);
-        cout << "\nMeal '" << mealName << "' saved!" << endl;
+        int score = meal.score();
+        long long id = history.save(mealName, meal, score);
+        if (id < 0) {
+            cout << "\nError: Could not save the meal." << endl;
+            return;
+        }
+        cout << "\nMeal '" << mealName << "' saved (score " << score << "/10)!" << endl;
     }
 
-    void loadMealFromHistory(int index) {
-        if (index < 0 || index >= mealHistory.size()) {
+    void loadMealFromHistory(long long id) {
+        auto found = history.meals().find(id);
+        if (found == history.meals().end() || !history.load(id, meal)) {
             cout << "Invalid selection." << endl;
             return;
         }
-        mealItems = mealHistory[index].items;
-        mealTotal = mealHistory[index].total;
-        cout << "\nMeal '" << mealHistory[index].name << "' loaded!" << endl;
+        cout << "\nMeal '" << found->second.name << "' loaded!" << endl;
     }
 
-    void deleteMealFromHistory(int index) {
-        if (index < 0 || index >= mealHistory.size()) {
+    void deleteMealFromHistory(long long id) {
+        auto found = history.meals().find(id);
+        if (found == history.meals().end()) {
             cout << "Invalid selection." << endl;
             return;
         }
-        string deletedName = mealHistory[index].name;
-        mealHistory.erase(mealHistory.begin() + index);
+        string deletedName = found->second.name;
+        if (!history.remove(id)) {
+            cout << "\nError: Could not delete the meal." << endl;
+            return;
+        }
         cout << "\nMeal '" << deletedName << "' deleted." << endl;
     }
 
@@ -306,14 +776,20 @@ public:
         cout << "           YOUR SAVED MEALS" << endl;
         cout << "========================================\n" << endl;
 
-        if (mealHistory.empty()) {
+        if (history.size() == 0) {
             cout << "No meals saved yet." << endl;
             return;
         }
 
-        for (size_t i = 0; i < mealHistory.size(); ++i) {
-            cout << (i + 1) << ". " << mealHistory[i].name << endl;
-            cout << "   Score: " << mealHistory[i].score << "/10 - " << mealHistory[i].items.size() << " items" << endl;
+        vector<long long> shown;
+        for (auto it = history.meals().rbegin(); it != history.meals().rend() && shown.size() < HISTORY_SHOWN; ++it) {
+            const MealSummary& meal = it->second;
+            shown.push_back(meal.id);
+            cout << shown.size() << ". " << meal.name << endl;
+            cout << "   Score: " << meal.score << "/10 - " << meal.itemCount << " items" << endl;
+        }
+        if (history.size() > shown.size()) {
+            cout << "(the " << shown.size() << " most recent of " << history.size() << " saved meals)" << endl;
         }
 
         cout << "\n----------------------------------------" << endl;
@@ -325,18 +801,19 @@ public:
 
         int choice;
         cin >> choice;
-        int mealIndex;
+        size_t mealIndex;
+        auto selected = [&shown](size_t number) { return number >= 1 && number <= shown.size() ? shown[number - 1] : -1LL; };
 
         switch (choice) {
             case 1:
                 cout << "Enter meal number to load: ";
                 cin >> mealIndex;
-                loadMealFromHistory(mealIndex - 1);
+                loadMealFromHistory(selected(mealIndex));
                 break;
             case 2:
                 cout << "Enter meal number to delete: ";
                 cin >> mealIndex;
-                deleteMealFromHistory(mealIndex - 1);
+                deleteMealFromHistory(selected(mealIndex));
                 break;
             case 0:
             default:
@@ -345,19 +822,362 @@ public:
         }
     }
 
+    // Apply a delta CSV to the built indexes in place, without a reload
+    void applyDelta() {
+        cout << "\n========================================" << endl;
+        cout << "       APPLY DELTA CSV" << endl;
+        cout << "========================================\n" << endl;
+
+        cout << "Enter path to a delta CSV (optional 10th column: upsert/delete): ";
+        string path;
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        getline(cin, path);
+
+        vector<FoodDelta> deltas;
+        if (!DeltaCSV::load(path, deltas)) return;
+        if (deltas.empty()) {
+            cout << "No rows found in " << path << endl;
+            return;
+        }
+        if (!waitForIndexes()) return;
+
+        auto start = high_resolution_clock::now();
+        DeltaResult hashMapResult = DeltaCSV::apply(hashMap, deltas);
+        auto hashMapTime = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        DeltaResult trieResult = DeltaCSV::apply(trie, deltas);
+        auto trieTime = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+        dataVersion++;
+        cout << "\nApplied " << deltas.size() << " delta rows:" << endl;
+        cout << "HashMap: " << hashMapResult.updated << " updated, " << hashMapResult.added
+             << " added, " << hashMapResult.removed << " removed in " << hashMapTime << " microseconds" << endl;
+        cout << "Trie:    " << trieResult.updated << " updated, " << trieResult.added
+             << " added, " << trieResult.removed << " removed in " << trieTime << " microseconds" << endl;
+        if (hashMapResult.collapsed > 0) {
+            cout << hashMapResult.collapsed << " other foods shared an updated name and were replaced too" << endl;
+        }
+    }
+
     void displayStats() {
+        if (!waitForIndexes()) return;
         hashMap.printStats();
         trie.printStats();
+        refreshNameDictionary();
+        dictionary->printStats();
+        refreshRadixTree();
+        radixTree->printStats();
+        displayAnalytics();
+        if (compactNutrients) displayCompactNutrients();
+        displayDuplicates();
+    }
+
+    // Encode the nutrients as fixed point and check every row's score
+    // against the double one, unless already done for the current data
+    void refreshCompactNutrients() {
+        if (!compact.refresh([&](CompactNutrients& index) { index.build(hashMap); })) return;
+        const CompactNutrients::Verification& check = compact->verified();
+        cout << "Compact nutrients: " << check.rows << " foods verified in " << check.micros / 1000 << " ms, ";
+        if (check.ok()) {
+            cout << "every score matches";
+        } else {
+            cout << check.mismatches << " scores differ";
+        }
+        cout << " (" << check.inexact << " foods not stored exactly)" << endl;
+        for (const auto& mismatch : check.examples) {
+            cout << "  " << mismatch.food->name << ": " << mismatch.expected << " with doubles, " << mismatch.actual
+                 << " fixed point" << endl;
+        }
+    }
+
+    // The 16-bit columns against the analytics' doubles: size and the time
+    // of a score distribution pass over each
+    void displayCompactNutrients() {
+        refreshAnalytics();
+        refreshCompactNutrients();
+        uint64_t doubleCounts[11];
+        uint64_t compactCounts[11];
+        long long doubleTime = medianMicros([&]() { analytics->scoreCounts(doubleCounts); });
+        long long compactTime = medianMicros([&]() { compact->scoreCounts(compactCounts); });
+        bool same = equal(doubleCounts, doubleCounts + 11, compactCounts);
+
+        cout << "\n=== Compact Nutrients ===" << endl;
+        cout << "double columns: " << analytics->nutrientBytes() / 1024 << " KiB, score pass " << doubleTime
+             << " microseconds" << endl;
+        cout << "16-bit columns: " << compact->bytesUsed() / 1024 << " KiB, score pass " << compactTime
+             << " microseconds (median of " << TIMING_RUNS << " runs)" << endl;
+        cout << "Score distributions " << (same ? "match" : "differ") << endl;
+    }
+
+    // Near-duplicate clusters: how many foods they hide and the largest ones
+    void displayDuplicates() {
+        duplicates.refresh([&](DuplicateIndex& index) { index.build(hashMap); });
+        const DuplicateIndex::Stats& stats = duplicates->stats();
+        cout << "\n=== Near-Duplicates ===" << endl;
+        cout << stats.foods << " foods under " << stats.names << " distinct names, " << stats.namePairs
+             << " similar name pairs, " << stats.compared << " food pairs compared in " << stats.millis << " ms"
+             << endl;
+        cout << stats.duplicates << " foods are near-duplicates, in " << stats.clusters << " clusters (largest "
+             << stats.largest << ")" << endl;
+        vector<DuplicateIndex::Cluster> largest;
+        duplicates->largestClusters(5, largest);
+        for (const auto& cluster : largest) {
+            cout << "  " << setw(5) << cluster.size << "  " << cluster.representative->name << endl;
+        }
+    }
+
+    // Copy the foods into columns for the analytics pass, unless already
+    // done for the current data
+    void refreshAnalytics() {
+        analytics.refresh([&](DatasetAnalytics& index) {
+            auto start = high_resolution_clock::now();
+            index.build(hashMap);
+            cout << "Analytics columns: " << index.size() << " foods copied in "
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - start).count() << " ms" << endl;
+        });
+    }
+
+    // Score distribution, nutrient percentiles, FSA "high" counts and the
+    // largest brand groups, from one pass over the data (over the 16-bit
+    // columns with --compact-nutrients, when they hold every value exactly)
+    void displayAnalytics() {
+        refreshAnalytics();
+        bool useCompact = false;
+        if (compactNutrients) {
+            refreshCompactNutrients();
+            useCompact = compact->verified().exact();
+            if (!useCompact) {
+                cout << "Warning: the 16-bit columns do not hold every value exactly; "
+                     << "analysing the double columns instead" << endl;
+            }
+        }
+        DatasetAnalytics::Result result =
+            analytics->run(thread::hardware_concurrency(), 10, useCompact ? &*compact : nullptr);
+        if (result.foods == 0) return;
+        auto share = [&result](uint64_t count) { return 100.0 * static_cast<double>(count) / result.foods; };
+
+        cout << "\n=== Dataset Analytics ===" << endl;
+        cout << result.foods << " foods analysed in " << result.micros << " microseconds on " << result.threads
+             << " thread(s)" << (useCompact ? " from the 16-bit columns" : "") << endl;
+        cout << fixed << setprecision(1);
+
+        cout << "\nScore distribution:" << endl;
+        for (int score = 10; score >= 1; score--) {
+            cout << "  " << setw(2) << score << "/10: " << setw(9) << result.scores[score] << " ("
+                 << setw(4) << share(result.scores[score]) << "%)" << endl;
+        }
+
+        static const char* const NUTRIENTS[FoodTable::FIELD_COUNT] = {
+            "kcal", "protein", "fat", "carbs", "sugar", "fiber", "satfat", "sodium"};
+        static const double QUANTILES[] = {0.05, 0.25, 0.5, 0.75, 0.95};
+        cout << "\nPer 100g (within about 1%):   p5      p25      p50      p75      p95" << endl;
+        for (int i = 0; i < FoodTable::FIELD_COUNT; i++) {
+            cout << "  " << left << setw(8) << NUTRIENTS[i] << right;
+            for (double q : QUANTILES) cout << setw(9) << result.nutrients[i].quantile(q);
+            cout << endl;
+        }
+
+        cout << "\nAbove the FSA \"high\" thresholds (per 100g):" << endl;
+        cout << "  fat > " << DatasetAnalytics::HIGH_FAT << "g: " << result.highFat << " (" << share(result.highFat)
+             << "%)" << endl;
+        cout << "  saturates > " << DatasetAnalytics::HIGH_SATFAT << "g: " << result.highSatfat << " ("
+             << share(result.highSatfat) << "%)" << endl;
+        cout << "  sugars > " << DatasetAnalytics::HIGH_SUGAR << "g: " << result.highSugar << " ("
+             << share(result.highSugar) << "%)" << endl;
+        cout << "  salt > 1.5g (sodium > " << DatasetAnalytics::HIGH_SODIUM << "mg): " << result.highSodium << " ("
+             << share(result.highSodium) << "%)" << endl;
+        cout << "  any of these: " << result.highAny << " (" << share(result.highAny) << "%)" << endl;
+
+        cout << "\nLargest groups by first word of the name:" << endl;
+        for (const auto& brand : result.brands) {
+            cout << "  " << left << setw(20) << brand.token << right << setw(9) << brand.foods
+                 << " foods, mean score " << brand.meanScore() << endl;
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
     }
 
-    void run() {
+    // Scripted mode: load quietly (progress goes to stderr), then answer
+    // every command from `in` on stdout through one large buffer
+    bool runBatch(const string& dataPath, const vector<string>& deltas, istream& in,
+                  BatchRunner::Format format, size_t limit) {
+        streambuf* original = cout.rdbuf(cerr.rdbuf());
+        bool loaded = loadData(dataPath, deltas);
+        cout.rdbuf(original);
+        if (!loaded) return false;
+
+        scores.refresh([&](ScoreIndex& index) { index.build(hashMap); });
+        OutputBuffer out(stdout);
+        BatchRunner runner(hashMap, trie, out, format, limit, &*scores, &*brands);
+        auto start = high_resolution_clock::now();
+        size_t lines = runner.run(in);
+        auto elapsed = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+        cerr << "Processed " << lines << " lines in " << elapsed << " microseconds" << endl;
+        return true;
+    }
+
+    // Offline mode: score a meal log (meal_id,food,grams rows grouped by
+    // meal) to CSV, loading the data quietly first
+    bool runScoreLog(const string& dataPath, const vector<string>& deltas, const string& logPath,
+                     const string& outPath, size_t threads) {
+        streambuf* original = cout.rdbuf(cerr.rdbuf());
+        bool loaded = loadData(dataPath, deltas);
+        cout.rdbuf(original);
+        if (!loaded) return false;
+
+        ifstream file;
+        if (logPath != "-") {
+            file.open(logPath, ios::binary);
+            if (!file.is_open()) {
+                cerr << "Error: Could not open file " << logPath << endl;
+                return false;
+            }
+        }
+        FILE* sink = stdout;
+        if (!outPath.empty()) {
+            sink = fopen(outPath.c_str(), "w");
+            if (sink == nullptr) {
+                cerr << "Error: Could not open file " << outPath << endl;
+                return false;
+            }
+        }
+
+        auto start = high_resolution_clock::now();
+        MealLogScorer::Stats stats;
+        {
+            OutputBuffer out(sink);
+            MealLogScorer scorer(hashMap);
+            stats = scorer.run(logPath == "-" ? cin : file, out, threads);
+        }
+        if (sink != stdout) fclose(sink);
+        auto elapsed = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+        cerr << "Scored " << stats.meals << " meals from " << stats.rows << " rows in " << elapsed << " ms ("
+             << stats.unresolved << " unresolved foods, " << stats.malformed << " malformed rows, "
+             << threads << " threads)" << endl;
+        return true;
+    }
+
+    // Scripted day plan: load quietly, then print one plan to stdout
+    bool runPlanDay(const string& dataPath, const vector<string>& deltas, double kcal,
+                    unsigned long long seed, size_t threads) {
+        streambuf* original = cout.rdbuf(cerr.rdbuf());
+        bool loaded = loadData(dataPath, deltas);
+        if (loaded) refreshNutrientIndex();
+        cout.rdbuf(original);
+        if (!loaded) return false;
+
+        DayPlanner::Targets targets;
+        targets.kcal = kcal;
+        DayPlanner::Settings settings;
+        settings.seed = seed;
+        settings.threads = threads;
+        DayPlanner planner(*nutrients);
+        printDayPlan(planner.plan(targets, settings), targets);
+        return true;
+    }
+
+#if defined(__linux__)
+    // Quiet period after the last change event before a reload starts, so
+    // a file being written in several steps is read once, when complete
+    static const int RELOAD_QUIET_MS = 300;
+
+    // Rebuild the snapshot (deltas included) whenever the data file changes.
+    // Queries keep running on the old version until the new one is published.
+    static void watchAndReload(const string& path, const vector<string>& deltas,
+                               SnapshotCell<DataSnapshot>& data, const atomic<bool>& stop) {
+        FileWatcher watcher(path);
+        if (!watcher.ok()) {
+            cerr << "Warning: cannot watch " << path << "; hot reload disabled." << endl;
+            return;
+        }
+        unsigned long long version = data.read()->version;
+        while (!stop.load()) {
+            if (!watcher.waitForChange(200)) continue;
+            while (!stop.load() && watcher.waitForChange(RELOAD_QUIET_MS)) {
+            }
+            if (stop.load()) break;
+
+            auto start = high_resolution_clock::now();
+            unique_ptr<DataSnapshot> next = DataSnapshot::load(path, version + 1, deltas);
+            if (!next) {
+                cerr << "Reload of " << path << " failed; still serving version " << version << endl;
+                continue;
+            }
+            size_t foods = next->stats.foods;
+            data.publish(move(next));
+            version++;
+            cout << "Reloaded " << path << ": version " << version << ", " << foods << " foods in "
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - start).count()
+                 << " ms" << endl;
+        }
+    }
+#endif
+
+    // Local HTTP mode: serve webRoot statically plus the JSON query API.
+    // With `watch`, the data file is reloaded whenever it changes.
+    bool runServer(const string& dataPath, const vector<string>& deltas, int port,
+                   const string& webRoot, size_t threads, bool watch, const atomic<bool>& stop) {
+#if defined(__linux__)
+        cout << "\n========================================" << endl;
+        cout << "   MEAL QUALITY SCORER - DATA LOADING" << endl;
+        cout << "========================================\n" << endl;
+        cout << "Loading data from " << dataPath << "..." << endl;
+        unique_ptr<DataSnapshot> initial = DataSnapshot::load(dataPath, 1, deltas);
+        if (!initial) {
+            cout << "Error: No data loaded!" << endl;
+            return false;
+        }
+        cout << "Loaded " << initial->stats.foods << " food items in " << initial->parseMs() << " ms." << endl;
+        cout << "HashMap build time: " << initial->stats.hashMapBuildMs << " ms" << endl;
+        cout << "Trie build time: " << initial->stats.trieBuildMs << " ms" << endl;
+        cout << "Total index build time: " << initial->stats.indexBuildMs << " ms" << endl;
+        cout << "========================================\n" << endl;
+        SnapshotCell<DataSnapshot> data(move(initial));
+
+        ThreadPool pool(threads);
+        QueryService service(data, &pool);
+        HttpServer server(webRoot, &pool);
+        service.registerRoutes(server);
+        if (!server.listen(port)) return false;
+
+        thread reloader;
+        if (watch) {
+            reloader = thread(watchAndReload, cref(dataPath), cref(deltas), ref(data), cref(stop));
+            cout << "Watching " << dataPath << " for changes" << endl;
+        }
+        cout << "Serving " << webRoot << " and the query API on http://127.0.0.1:"
+             << port << "/ with " << pool.size() << " worker threads (Ctrl+C to stop)" << endl;
+        server.run(stop);
+        if (reloader.joinable()) reloader.join();
+        cout << "\nServer stopped." << endl;
+        return true;
+#else
+        (void)dataPath; (void)deltas; (void)port; (void)webRoot; (void)threads; (void)watch; (void)stop;
+        cerr << "Error: server mode requires Linux (epoll)." << endl;
+        return false;
+#endif
+    }
+
+    void run(const string& dataPath, const vector<string>& deltas, const string& historyPath,
+             long long optimizeMs) {
+        optimizeBudgetMs = optimizeMs;
         cout << "\n========================================" << endl;
         cout << "   MEAL QUALITY SCORER" << endl;
         cout << "   Created by: Noah Chae, Emmett Bradford, Josh Hoeckendorf" << endl;
         cout << "========================================\n" << endl;
 
-        loadData("../../web/data/nutrition_100k_branded.csv");
-        mealTotal.name = "";
+        // Load in the background so the menu is usable right away
+        cout << "Loading " << dataPath << " in the background..." << endl;
+        startLoading(dataPath, deltas);
+        auto historyStart = high_resolution_clock::now();
+        if (history.open(historyPath)) {
+            cout << "Meal history: " << history.size() << " saved meals from " << historyPath << " ("
+                 << duration_cast<milliseconds>(high_resolution_clock::now() - historyStart).count()
+                 << " ms)" << endl;
+        } else {
+            cout << "Warning: meal history is unavailable; saved meals will not be kept." << endl;
+        }
 
         while (true) {
             cout << "\n========================================" << endl;
@@ -370,9 +1190,14 @@ public:
             cout << "5. Save Current Meal" << endl;
             cout << "6. View Meal History" << endl;
             cout << "7. Display data structure statistics" << endl;
-            cout << "8. Exit" << endl;
+            cout << "8. Batch exact search (from file)" << endl;
+            cout << "9. Apply delta CSV (upsert/delete)" << endl;
+            cout << "10. Optimize meal (suggest swaps)" << endl;
+            cout << "11. Plan a day of meals" << endl;
+            cout << "12. Exit" << endl;
             cout << "========================================" << endl;
-            cout << "Current meal items: " << mealItems.size() << endl;
+            cout << "Data: " << loader.status() << endl;
+            cout << "Current meal items: " << meal.size() << endl;
             cout << "\nChoice: ";
 
             int choice;
@@ -401,6 +1226,18 @@ public:
                     displayStats();
                     break;
                 case 8:
+                    batchSearch();
+                    break;
+                case 9:
+                    applyDelta();
+                    break;
+                case 10:
+                    optimizeMeal();
+                    break;
+                case 11:
+                    planDay();
+                    break;
+                case 12:
                     cout << "\nThank you for using Meal Quality Scorer!" << endl;
                     return;
                 default:
@@ -414,8 +1251,132 @@ public:
     }
 };
 
-int main() {
+atomic<bool> stopRequested(false);
+
+void handleStopSignal(int) {
+    stopRequested.store(true);
+}
+
+void printUsage(const char* program) {
+    cerr << "Usage: " << program << " [--data <csv>] [--batch <file|->]"
+         << " [--format jsonl|tsv] [--limit <n>] [--serve <port>] [--web <dir>]"
+         << " [--threads <n>] [--watch] [--delta <csv>]... [--history <file>]"
+         << " [--score-log <file|-> [--out <csv>]] [--optimize-ms <n>]"
+         << " [--plan-day <kcal> [--seed <n>]] [--compact-nutrients]" << endl;
+    cerr << "  --data    nutrition CSV to load" << endl;
+    cerr << "  --batch   run commands from a file ('-' for stdin) instead of the menu" << endl;
+    cerr << "  --format  batch output format (default jsonl)" << endl;
+    cerr << "  --limit   results printed per search in batch mode (default 10)" << endl;
+    cerr << "  --serve   run the HTTP/JSON query server on 127.0.0.1:<port>" << endl;
+    cerr << "  --web     directory served as static files (default ../../web)" << endl;
+    cerr << "  --threads server worker threads (default: one per core)" << endl;
+    cerr << "  --watch   reload the data file whenever it changes (server mode)" << endl;
+    cerr << "  --delta   apply a delta CSV (upserts/deletes by name) after loading; repeatable" << endl;
+    cerr << "  --history meal history log (default " << MEAL_DEFAULT_HISTORY_PATH << ")" << endl;
+    cerr << "  --score-log score a meal_id,food,grams log (grouped by meal) to CSV; --threads applies" << endl;
+    cerr << "  --out     where --score-log writes its CSV (default stdout)" << endl;
+    cerr << "  --optimize-ms time budget of the meal optimizer (default "
+         << MealOptimizer::Settings().budgetMs << ")" << endl;
+    cerr << "  --plan-day print a day of meals for this energy target; --threads applies" << endl;
+    cerr << "  --seed    day planner seed (default " << DayPlanner::Settings().seed << ")" << endl;
+    cerr << "  --compact-nutrients also keep the nutrients as 16-bit fixed point, verifying every score," << endl;
+    cerr << "            and score the statistics screen from them (not with --serve)" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string dataPath = MEAL_DEFAULT_DATA_PATH;
+    string batchPath;
+    BatchRunner::Format format = BatchRunner::Format::JSONL;
+    size_t limit = 10;
+    int port = 0;
+    string webRoot = "../../web";
+    size_t threads = thread::hardware_concurrency();
+    bool watch = false;
+    vector<string> deltas;
+    string historyPath = MEAL_DEFAULT_HISTORY_PATH;
+    string scoreLogPath;
+    string outPath;
+    long long optimizeMs = MealOptimizer::Settings().budgetMs;
+    double planKcal = 0;
+    unsigned long long seed = DayPlanner::Settings().seed;
+    bool compactNutrients = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--data" && hasValue) {
+            dataPath = argv[++i];
+        } else if (arg == "--batch" && hasValue) {
+            batchPath = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            string value = argv[++i];
+            if (value == "tsv") {
+                format = BatchRunner::Format::TSV;
+            } else if (value != "jsonl") {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--limit" && hasValue) {
+            limit = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--serve" && hasValue) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--web" && hasValue) {
+            webRoot = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            threads = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--watch") {
+            watch = true;
+        } else if (arg == "--delta" && hasValue) {
+            deltas.push_back(argv[++i]);
+        } else if (arg == "--history" && hasValue) {
+            historyPath = argv[++i];
+        } else if (arg == "--score-log" && hasValue) {
+            scoreLogPath = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            outPath = argv[++i];
+        } else if (arg == "--optimize-ms" && hasValue) {
+            optimizeMs = atoll(argv[++i]);
+        } else if (arg == "--plan-day" && hasValue) {
+            planKcal = atof(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--compact-nutrients") {
+            compactNutrients = true;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (compactNutrients && port > 0) {
+        cerr << "Error: --compact-nutrients is not supported with --serve" << endl;
+        return 1;
+    }
+
     MealQualityScorer scorer;
-    scorer.run();
+    if (compactNutrients) scorer.useCompactNutrients();
+    if (port > 0) {
+        signal(SIGINT, handleStopSignal);
+        signal(SIGTERM, handleStopSignal);
+        return scorer.runServer(dataPath, deltas, port, webRoot, threads, watch, stopRequested) ? 0 : 1;
+    }
+    if (!scoreLogPath.empty()) {
+        return scorer.runScoreLog(dataPath, deltas, scoreLogPath, outPath, threads) ? 0 : 1;
+    }
+    if (planKcal > 0) {
+        return scorer.runPlanDay(dataPath, deltas, planKcal, seed, threads) ? 0 : 1;
+    }
+    if (!batchPath.empty()) {
+        if (batchPath == "-") {
+            return scorer.runBatch(dataPath, deltas, cin, format, limit) ? 0 : 1;
+        }
+        ifstream input(batchPath);
+        if (!input.is_open()) {
+            cerr << "Error: Could not open file " << batchPath << endl;
+            return 1;
+        }
+        return scorer.runBatch(dataPath, deltas, input, format, limit) ? 0 : 1;
+    }
+    scorer.run(dataPath, deltas, historyPath, optimizeMs);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,308 @@
+// Synthetic nutrition dataset generator for scale testing.
+//
+// Learns from a seed CSV (same format as the real dataset):
+//   - name length in tokens,
+//   - token bigrams (which word follows which), falling back to unigrams,
+//   - the rate of names that repeat an earlier name exactly,
+//   - nutrient vectors, sampled jointly from seed rows with small jitter.
+// Every row is derived from (seed, row index) alone, so output is identical
+// across runs and platforms, and duplicates are produced by regenerating an
+// earlier row's name rather than remembering it.
+//
+//   MealDataGen --seed-file nutrition_100k_branded.csv --rows 10000000 --seed 1 --out big.csv
+//
+// With --meals it writes a meal log for --score-log instead: rows of
+// meal_id,food,grams grouped by meal, 1-6 seed foods per meal and about 2%
+// of names that match nothing.
+//
+//   MealDataGen --seed-file nutrition_100k_branded.csv --meals 1000000 --out meals.csv
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "Food.h"
+#include "CSVReader.h"
+#include "OutputBuffer.h"
+
+using namespace std;
+
+// splitmix64: mixes (seed, row) into an independent stream per row
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+struct RowRng {
+    uint64_t state;
+    RowRng(uint64_t seed, uint64_t row, uint64_t stream) : state(mix64(seed ^ mix64(row * 4 + stream))) {}
+    uint64_t next() {
+        state = mix64(state);
+        return state;
+    }
+    size_t below(size_t n) { return static_cast<size_t>(next() % n); }
+    double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); } // [0, 1)
+};
+
+// Discrete distribution stored as a cumulative weight table
+struct WeightedChoice {
+    vector<uint32_t> values;
+    vector<uint64_t> cumulative;
+
+    void add(uint32_t value, uint64_t weight) {
+        values.push_back(value);
+        cumulative.push_back((cumulative.empty() ? 0 : cumulative.back()) + weight);
+    }
+    bool empty() const { return values.empty(); }
+    uint32_t pick(RowRng& rng) const {
+        uint64_t target = rng.next() % cumulative.back();
+        size_t index = upper_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin();
+        return values[index];
+    }
+};
+
+class NameModel {
+    static const uint32_t START = 0xFFFFFFFF;
+
+    vector<string> tokens;
+    unordered_map<string, uint32_t> tokenIds;
+    WeightedChoice lengths;
+    WeightedChoice unigrams;
+    unordered_map<uint32_t, WeightedChoice> bigrams;
+
+    static vector<string> split(const string& name) {
+        vector<string> parts;
+        size_t start = 0;
+        while (start < name.size()) {
+            size_t end = name.find(' ', start);
+            if (end == string::npos) end = name.size();
+            if (end > start) parts.push_back(name.substr(start, end - start));
+            start = end + 1;
+        }
+        return parts;
+    }
+
+public:
+    double duplicateRate = 0;
+
+    void train(const vector<Food>& foods) {
+        unordered_map<uint32_t, uint64_t> lengthCounts;
+        unordered_map<uint32_t, uint64_t> unigramCounts;
+        unordered_map<uint32_t, unordered_map<uint32_t, uint64_t>> bigramCounts;
+        unordered_set<string> seen;
+        size_t duplicates = 0;
+
+        for (const auto& food : foods) {
+            if (!seen.insert(food.name).second) {
+                duplicates++;
+                continue; // repeats are modelled by duplicateRate only
+            }
+            vector<string> parts = split(food.name);
+            if (parts.empty()) continue;
+            lengthCounts[parts.size()]++;
+            uint32_t prev = START;
+            for (const auto& part : parts) {
+                auto inserted = tokenIds.emplace(part, static_cast<uint32_t>(tokens.size()));
+                if (inserted.second) tokens.push_back(part);
+                uint32_t id = inserted.first->second;
+                unigramCounts[id]++;
+                bigramCounts[prev][id]++;
+                prev = id;
+            }
+        }
+        duplicateRate = foods.empty() ? 0 : static_cast<double>(duplicates) / foods.size();
+
+        // Sorted keys so the tables do not depend on hash map iteration order
+        auto addSorted = [](WeightedChoice& choice, const unordered_map<uint32_t, uint64_t>& counts) {
+            vector<pair<uint32_t, uint64_t>> entries(counts.begin(), counts.end());
+            sort(entries.begin(), entries.end());
+            for (const auto& entry : entries) choice.add(entry.first, entry.second);
+        };
+        addSorted(lengths, lengthCounts);
+        addSorted(unigrams, unigramCounts);
+        for (const auto& entry : bigramCounts) {
+            addSorted(bigrams[entry.first], entry.second);
+        }
+    }
+
+    bool empty() const { return tokens.empty(); }
+    size_t vocabulary() const { return tokens.size(); }
+
+    string generate(RowRng& rng) const {
+        uint32_t length = lengths.pick(rng);
+        string name;
+        uint32_t prev = START;
+        for (uint32_t i = 0; i < length; i++) {
+            auto it = bigrams.find(prev);
+            uint32_t id = (it != bigrams.end() && !it->second.empty()) ? it->second.pick(rng)
+                                                                       : unigrams.pick(rng);
+            if (!name.empty()) name += ' ';
+            name += tokens[id];
+            prev = id;
+        }
+        return name;
+    }
+};
+
+struct NutrientModel {
+    vector<Food> rows;
+
+    // Nutrients of a random seed row, each scaled by up to +/-5% and kept
+    // consistent (sugar <= carbs, saturated fat <= fat)
+    Food sample(RowRng& rng) const {
+        const Food& base = rows[rng.below(rows.size())];
+        auto jitter = [&rng](double value) {
+            double scaled = value * (0.95 + 0.1 * rng.unit());
+            return round(scaled * 100) / 100;
+        };
+        Food food;
+        food.kcal = jitter(base.kcal);
+        food.protein = jitter(base.protein);
+        food.fat = jitter(base.fat);
+        food.carbs = jitter(base.carbs);
+        food.sugar = min(jitter(base.sugar), food.carbs);
+        food.fiber = jitter(base.fiber);
+        food.satfat = min(jitter(base.satfat), food.fat);
+        food.sodium = jitter(base.sodium);
+        return food;
+    }
+};
+
+// A row either repeats an earlier row's name or gets a fresh one. Following
+// the chain of repeats back to a fresh row keeps duplicates exact.
+static string nameForRow(const NameModel& names, uint64_t seed, uint64_t row) {
+    while (row > 0) {
+        RowRng rng(seed, row, 1);
+        if (rng.unit() >= names.duplicateRate) break;
+        row = rng.below(row);
+    }
+    RowRng rng(seed, row, 0);
+    return names.generate(rng);
+}
+
+// Meal `meal` of a synthetic meal log, one row per item
+static void writeMeal(OutputBuffer& out, const vector<Food>& foods, uint64_t seed, uint64_t meal) {
+    RowRng rng(seed, meal, 3);
+    size_t items = 1 + rng.below(6);
+    for (size_t i = 0; i < items; i++) {
+        string name = foods[rng.below(foods.size())].name;
+        if (rng.below(50) == 0) name += " QZX";
+        double grams = 20 + rng.below(381);
+        out.append(static_cast<long long>(meal)).append(',');
+        if (name.find(',') != string::npos) {
+            out.append('"').append(name).append('"');
+        } else {
+            out.append(name);
+        }
+        out.append(',').appendFixed(grams, 0).append('\n');
+    }
+}
+
+int main(int argc, char* argv[]) {
+    string seedFile;
+    string outPath;
+    uint64_t rows = 100000;
+    uint64_t meals = 0;
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seed-file" && hasValue) {
+            seedFile = argv[++i];
+        } else if (arg == "--rows" && hasValue) {
+            rows = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--meals" && hasValue) {
+            meals = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--out" && hasValue) {
+            outPath = argv[++i];
+        } else {
+            seedFile.clear();
+            break;
+        }
+    }
+    if (seedFile.empty()) {
+        cerr << "Usage: " << argv[0] << " --seed-file <csv> [--rows <n> | --meals <n>] [--seed <n>] [--out <csv>]" << endl;
+        return 1;
+    }
+
+    streambuf* original = cout.rdbuf(cerr.rdbuf());
+    vector<Food> seedFoods = CSVReader::loadFromCSV(seedFile);
+    cout.rdbuf(original);
+
+    if (meals > 0) {
+        if (seedFoods.empty()) {
+            cerr << "Error: seed file has no rows." << endl;
+            return 1;
+        }
+        FILE* sink = outPath.empty() ? stdout : fopen(outPath.c_str(), "w");
+        if (sink == nullptr) {
+            cerr << "Error: Could not open file " << outPath << endl;
+            return 1;
+        }
+        {
+            OutputBuffer out(sink);
+            out.append("meal_id,food,grams\n");
+            for (uint64_t meal = 0; meal < meals; meal++) writeMeal(out, seedFoods, seed, meal);
+        }
+        if (sink != stdout) fclose(sink);
+        cerr << "Wrote " << meals << " meals" << (outPath.empty() ? "" : " to " + outPath) << endl;
+        return 0;
+    }
+
+    NameModel names;
+    names.train(seedFoods);
+    if (names.empty()) {
+        cerr << "Error: seed file has no usable names." << endl;
+        return 1;
+    }
+    NutrientModel nutrients{std::move(seedFoods)};
+    cerr << "Seed model: " << nutrients.rows.size() << " rows, " << names.vocabulary()
+         << " distinct tokens, duplicate rate " << names.duplicateRate << endl;
+
+    FILE* sink = stdout;
+    if (!outPath.empty()) {
+        sink = fopen(outPath.c_str(), "w");
+        if (sink == nullptr) {
+            cerr << "Error: Could not open file " << outPath << endl;
+            return 1;
+        }
+    }
+
+    {
+        OutputBuffer out(sink);
+        out.append("name,kcal,protein,fat,carbs,sugar,fiber,satfat,sodium\n");
+        for (uint64_t row = 0; row < rows; row++) {
+            string name = nameForRow(names, seed, row);
+            RowRng rng(seed, row, 2);
+            Food food = nutrients.sample(rng);
+
+            if (name.find(',') != string::npos) {
+                out.append('"').append(name).append('"');
+            } else {
+                out.append(name);
+            }
+            out.append(',').appendFixed(food.kcal)
+               .append(',').appendFixed(food.protein)
+               .append(',').appendFixed(food.fat)
+               .append(',').appendFixed(food.carbs)
+               .append(',').appendFixed(food.sugar)
+               .append(',').appendFixed(food.fiber)
+               .append(',').appendFixed(food.satfat)
+               .append(',').appendFixed(food.sodium)
+               .append('\n');
+        }
+    }
+    if (sink != stdout) fclose(sink);
+    cerr << "Wrote " << rows << " rows" << (outPath.empty() ? "" : " to " + outPath) << endl;
+    return 0;
+}
@@ -2,8 +2,13 @@
 let foodData = [];
 let mealItems = [];
 let currentSearchResults = [];
+let currentCompletions = [];
 let isDataLoaded = false;
 let currentMealForSave = null;
+// True when served by the C++ binary (--serve), which answers /search etc.
+let apiAvailable = false;
+let lastSearchMicros = null;
+let addSearchSeq = 0;
 
 // ---------- Bootstrap ----------
 window.addEventListener('DOMContentLoaded', async () => {
@@ -12,7 +17,8 @@ window.addEventListener('DOMContentLoaded', async () => {
   bindHistoryActions();
   loadHistory();
   showLoading(true);
-  await loadFoodData('data/nutrition_100k_branded.csv');
+  apiAvailable = await probeApi();
+  if (!apiAvailable) await loadFoodData('data/nutrition_100k_branded.csv');
   isDataLoaded = true;
   showLoading(false);
   updateMealCount();
@@ -79,6 +85,14 @@ function bindActions() {
     if (Number.isInteger(idx)) addFoodToMeal(idx);
   });
 
+  document.addEventListener('click', (e) => {
+    const btn = e.target.closest('[data-pick-index]');
+    if (!btn) return;
+    e.preventDefault();
+    const idx = parseInt(btn.dataset.pickIndex, 10);
+    if (Number.isInteger(idx)) pickCompletion(idx);
+  });
+
   const mealList = byId('mealItems');
   if (mealList) {
     mealList.addEventListener('click', (e) => {
@@ -91,6 +105,34 @@ function bindActions() {
 }
 
 // ---------- Data loading ----------
+async function probeApi() {
+  try {
+    const resp = await fetch('/stats');
+    if (!resp.ok) return false;
+    const stats = await resp.json();
+    return typeof stats.foods === 'number';
+  } catch (e) {
+    return false;
+  }
+}
+
+async function apiSearch(q, type, limit) {
+  const resp = await fetch(`/search?type=${type}&limit=${limit}&q=${encodeURIComponent(q)}`);
+  if (!resp.ok) throw new Error(`HTTP ${resp.status}`);
+  const data = await resp.json();
+  lastSearchMicros = data.micros;
+  return data.results;
+}
+
+// Distinct names starting with q; no food records are sent
+async function apiComplete(q, limit) {
+  const resp = await fetch(`/complete?limit=${limit}&q=${encodeURIComponent(q)}`);
+  if (!resp.ok) throw new Error(`HTTP ${resp.status}`);
+  const data = await resp.json();
+  lastSearchMicros = data.micros;
+  return data.names;
+}
+
 async function loadFoodData(url) {
   try {
     const resp = await fetch(url);
@@ -129,17 +171,25 @@ function parseCSV(text) {
 }
 
 // ---------- Search (view-only) ----------
-function searchFood() {
+async function searchFood() {
   if (!isDataLoaded) return showToast('Please wait for data to finish loading...', 'error');
   const q = document.getElementById('searchInput').value.trim().toLowerCase();
   if (!q) return showToast('Please enter a search term', 'error');
 
-  const results = [];
-  for (const f of foodData) {
-    // HashMap simulation: .includes()
-    if (f.name.toLowerCase().includes(q)) {
-      results.push(f);
-      if (results.length >= 50) break;
+  let results = [];
+  if (apiAvailable) {
+    try {
+      results = await apiSearch(q, 'contains', 50);
+    } catch (e) {
+      return showToast(`Search failed: ${e.message}`, 'error');
+    }
+  } else {
+    for (const f of foodData) {
+      // HashMap simulation: .includes()
+      if (f.name.toLowerCase().includes(q)) {
+        results.push(f);
+        if (results.length >= 50) break;
+      }
     }
   }
 
@@ -166,7 +216,7 @@ function renderFoodCard(food) {
 }
 
 // ---------- Add flow (Autocomplete) ----------
-function searchForAdd() {
+async function searchForAdd() {
   if (!isDataLoaded) return; // Don't search if data isn't ready
 
   const q = document.getElementById('addFoodInput').value.trim().toLowerCase();
@@ -176,6 +226,22 @@ function searchForAdd() {
   if (!q) {
     div.innerHTML = '';
     currentSearchResults = [];
+    currentCompletions = [];
+    return;
+  }
+
+  if (apiAvailable) {
+    // Type-ahead lists names only; the foods are fetched once one is picked.
+    // Ignore responses that arrive after a newer keystroke's request
+    const seq = ++addSearchSeq;
+    let names;
+    try {
+      names = await apiComplete(q, 30);
+    } catch (e) {
+      return;
+    }
+    if (seq !== addSearchSeq) return;
+    renderCompletions(names);
     return;
   }
 
@@ -187,6 +253,44 @@ function searchForAdd() {
       if (results.length >= 30) break;
     }
   }
+  renderAddResults(results);
+}
+
+function renderCompletions(names) {
+  const div = document.getElementById('addFoodResults');
+  currentCompletions = names;
+  currentSearchResults = [];
+  if (!names.length) {
+    div.innerHTML = '<p>No foods found starting with that.</p>';
+    return;
+  }
+  div.innerHTML = `
+    <h4>Select a food:</h4>
+    ${names.map((name, i) => `
+      <div class="food-card" data-pick-index="${i}">
+        <h4>${name}</h4>
+      </div>
+    `).join('')}
+  `;
+}
+
+// Fetch the foods under a completed name and offer them for adding
+async function pickCompletion(index) {
+  if (index < 0 || index >= currentCompletions.length) return;
+  const name = currentCompletions[index];
+  const seq = ++addSearchSeq;
+  let results;
+  try {
+    results = await apiSearch(name, 'exact', 30);
+  } catch (e) {
+    return showToast(`Search failed: ${e.message}`, 'error');
+  }
+  if (seq !== addSearchSeq) return;
+  renderAddResults(results);
+}
+
+function renderAddResults(results) {
+  const div = document.getElementById('addFoodResults');
   currentSearchResults = results;
 
   if (!results.length) {
@@ -244,6 +348,7 @@ function addFoodToMeal(index) {
   document.getElementById('addFoodInput').value = '';
   document.getElementById('addFoodResults').innerHTML = '';
   currentSearchResults = [];
+  currentCompletions = [];
 }
 
 // ---------- Score screen ----------
@@ -339,7 +444,8 @@ function clearMeal() {
 }
 
 // ---------- Statistics (educational summary) ----------
-function displayStatistics() {
+async function displayStatistics() {
+  if (apiAvailable) return displayServerStatistics();
   const total = foodData.length || 0;
   const hashTime = total ? '70-90ms' : 'N/A';
   const trieTime = total ? '250-300ms' : 'N/A';
@@ -369,6 +475,39 @@ function displayStatistics() {
   `;
 }
 
+async function displayServerStatistics() {
+  let stats;
+  try {
+    stats = await (await fetch('/stats')).json();
+  } catch (e) {
+    return showToast(`Could not load statistics: ${e.message}`, 'error');
+  }
+  const avg = stats.requests ? (stats.searchMicros / stats.requests).toFixed(0) : 'N/A';
+
+  document.getElementById('hashMapStats').innerHTML = `
+    <h3>HashMap (C++ server)</h3>
+    <div class="stat-item"><span class="stat-label">Total Items:</span><span class="stat-value">${stats.foods}</span></div>
+    <div class="stat-item"><span class="stat-label">C++ Build Time:</span><span class="stat-value">${stats.hashMapBuildMs}ms</span></div>
+    <div class="stat-item"><span class="stat-label">Web Search:</span><span class="stat-value">/search?type=contains</span></div>
+  `;
+
+  document.getElementById('trieStats').innerHTML = `
+    <h3>Trie (C++ server)</h3>
+    <div class="stat-item"><span class="stat-label">Total Items:</span><span class="stat-value">${stats.foods}</span></div>
+    <div class="stat-item"><span class="stat-label">C++ Build Time:</span><span class="stat-value">${stats.trieBuildMs}ms</span></div>
+    <div class="stat-item"><span class="stat-label">Web Search:</span><span class="stat-value">/search?type=prefix</span></div>
+  `;
+
+  document.getElementById('perfStats').innerHTML = `
+    <h3>Performance Comparison</h3>
+    <p><strong>Last search:</strong> ${lastSearchMicros ?? 'N/A'} microseconds in the C++ index.</p>
+    <p><strong>Requests served:</strong> ${stats.requests} (avg ${avg} microseconds of index time per request)</p>
+    <p style="margin-top:8px;font-size:.9em;color:#666;">
+      These are measured by the C++ server; only the matching rows are sent to the browser.
+    </p>
+  `;
+}
+
 // ---------- History Functions ----------
 function loadHistory() {
   const history = JSON.parse(localStorage.getItem('mealHistory') || '[]');